@@ -0,0 +1,98 @@
+#include "AdaptiveMonitor.h"
+#include "ResultBusPublisher.h"
+
+AdaptiveMonitor::AdaptiveMonitor(QObject* parent)
+    : QObject(parent)
+{
+    engine_.setMaxConcurrent(64);
+    wake_.setSingleShot(true);
+    connect(&wake_, &QTimer::timeout, this, &AdaptiveMonitor::onWake);
+}
+
+void AdaptiveMonitor::start(const QStringList& targets)
+{
+    stop();
+
+    targets_ = targets;
+    probesSent_ = 0;
+    clock_.start();
+    for (int i = 0; i < targets_.size(); ++i)
+        controller_.addTarget(i, 0);
+
+    running_ = true;
+    scheduleWake();
+}
+
+void AdaptiveMonitor::stop()
+{
+    running_ = false;
+    ++generation_;
+    wake_.stop();
+    engine_.cancelAll();
+    controller_.clear();
+}
+
+double AdaptiveMonitor::elapsedSec() const
+{
+    return clock_.isValid() ? clock_.elapsed() / 1000.0 : 0.0;
+}
+
+void AdaptiveMonitor::onWake()
+{
+    if (!running_) return;
+
+    const qint64 now = clock_.elapsed();
+    for (int id : controller_.dueTargets(now))
+    {
+        if (!controller_.tryAcquire(now))
+            break; // global budget exhausted; scheduleWake() waits for a token
+
+        controller_.markSent(id, now);
+        ++probesSent_;
+
+        ProbeJob job = template_;
+        job.host = targets_[id];
+        job.ping.count = 1;
+
+        const quint64 gen = generation_;
+        engine_.submit(job, [this, id, gen](const ProbeResult& r)
+        {
+            if (!running_ || gen != generation_ || r.cancelled) return;
+
+            AdaptiveProbeReport rep;
+            rep.targetId = id;
+            rep.target = targets_[id];
+            // A reply without an RTT (Windows counts "Destination host
+            // unreachable" as received) is no evidence the target is up.
+            rep.replied = r.stats.hasPacketStats && r.stats.received > 0 && r.stats.hasRtt;
+            rep.rttMs = rep.replied ? r.stats.rttAvgMs : -1.0;
+            rep.verdict = controller_.onResult(id, rep.replied, rep.rttMs);
+            rep.nextIntervalSec = controller_.intervalSec(id);
+            if (bus_) bus_->publish(rep.target, rep.replied, rep.rttMs);
+            emit probeResult(rep);
+
+            scheduleWake();
+        });
+    }
+
+    scheduleWake();
+}
+
+void AdaptiveMonitor::scheduleWake()
+{
+    if (!running_) return;
+
+    const qint64 now = clock_.elapsed();
+    const qint64 due = controller_.nextWakeMs();
+    if (due < 0)
+    {
+        // Everything is in flight; the next result re-arms the timer.
+        wake_.stop();
+        return;
+    }
+
+    qint64 delay = qMax<qint64>(0, due - now);
+    if (delay == 0)
+        delay = controller_.msUntilToken(now);
+    wake_.start(static_cast<int>(delay));
+}
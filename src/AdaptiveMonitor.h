@@ -0,0 +1,71 @@
+#pragma once
+#include <QElapsedTimer>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+
+#include "AdaptiveRateController.h"
+#include "ProbeEngine.h"
+
+class ResultBusPublisher;
+
+struct AdaptiveProbeReport
+{
+    int targetId = -1;
+    QString target;
+    bool replied = false;
+    double rttMs = -1.0;
+    ProbeVerdict verdict = ProbeVerdict::Warmup;
+    double nextIntervalSec = 0.0;
+};
+
+// Continuous monitoring of many targets with one-shot probes whose rate is
+// set per target by AdaptiveRateController, within the per-target and
+// global packets-per-second budgets.
+class AdaptiveMonitor final : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit AdaptiveMonitor(QObject* parent = nullptr);
+
+    void setOptions(const AdaptiveRateOptions& opt) { controller_.setOptions(opt); }
+    const AdaptiveRateOptions& options() const { return controller_.options(); }
+
+    // Ping or TcpConnect; host is set per target and count forced to 1.
+    void setProbeTemplate(const ProbeJob& job) { template_ = job; }
+
+    // Optional: every result is also published there (not owned).
+    void setResultBus(ResultBusPublisher* bus) { bus_ = bus; }
+
+    void start(const QStringList& targets);
+    void stop();
+    bool isRunning() const { return running_; }
+
+    const QStringList& targets() const { return targets_; }
+    qint64 probesSent() const { return probesSent_; }
+    double elapsedSec() const;
+
+    ProbeEngine& engine() { return engine_; }
+
+signals:
+    void probeResult(const AdaptiveProbeReport& report);
+
+private slots:
+    void onWake();
+
+private:
+    void scheduleWake();
+
+    AdaptiveRateController controller_;
+    ProbeEngine engine_;
+    ProbeJob template_;
+    ResultBusPublisher* bus_ = nullptr;
+    QStringList targets_;
+    QElapsedTimer clock_;
+    QTimer wake_;
+    bool running_ = false;
+    qint64 probesSent_ = 0;
+    quint64 generation_ = 0;  // results of a previous start() are ignored
+};
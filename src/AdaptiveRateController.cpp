@@ -0,0 +1,202 @@
+#include "AdaptiveRateController.h"
+
+#include <QPair>
+#include <algorithm>
+#include <cmath>
+
+static constexpr int kWarmupSamples = 3;
+
+AdaptiveRateController::AdaptiveRateController(const AdaptiveRateOptions& opt)
+    : opt_(opt)
+{
+}
+
+void AdaptiveRateController::setOptions(const AdaptiveRateOptions& opt)
+{
+    opt_ = opt;
+    for (auto& t : targets_)
+        t.intervalSec = qBound(opt_.minIntervalSec, t.intervalSec, opt_.maxIntervalSec);
+}
+
+void AdaptiveRateController::addTarget(int targetId, qint64 nowMs)
+{
+    Target t;
+    t.intervalSec = opt_.minIntervalSec;
+    t.nextDueMs = nowMs;
+    targets_.insert(targetId, t);
+}
+
+void AdaptiveRateController::removeTarget(int targetId)
+{
+    targets_.remove(targetId);
+}
+
+void AdaptiveRateController::clear()
+{
+    targets_.clear();
+    tokensAtMs_ = -1;
+}
+
+double AdaptiveRateController::effectiveInterval(const Target& t) const
+{
+    double iv = t.intervalSec;
+    if (opt_.perTargetMaxPps > 0.0)
+        iv = qMax(iv, 1.0 / opt_.perTargetMaxPps);
+    return iv;
+}
+
+QVector<int> AdaptiveRateController::dueTargets(qint64 nowMs) const
+{
+    QVector<QPair<qint64, int>> due;
+    for (auto it = targets_.constBegin(); it != targets_.constEnd(); ++it)
+    {
+        if (!it->inFlight && it->nextDueMs <= nowMs)
+            due << qMakePair(it->nextDueMs, it.key());
+    }
+    std::sort(due.begin(), due.end());
+
+    QVector<int> ids;
+    ids.reserve(due.size());
+    for (const auto& d : due)
+        ids << d.second;
+    return ids;
+}
+
+void AdaptiveRateController::refill(qint64 nowMs)
+{
+    // Burst of up to one second's worth of probes.
+    const double burst = qMax(1.0, opt_.globalMaxPps);
+    if (tokensAtMs_ < 0)
+        tokens_ = burst;
+    else
+        tokens_ = qMin(burst, tokens_ + (nowMs - tokensAtMs_) / 1000.0 * opt_.globalMaxPps);
+    tokensAtMs_ = nowMs;
+}
+
+bool AdaptiveRateController::tryAcquire(qint64 nowMs)
+{
+    if (opt_.globalMaxPps <= 0.0)
+        return true;
+
+    refill(nowMs);
+    if (tokens_ < 1.0)
+        return false;
+    tokens_ -= 1.0;
+    return true;
+}
+
+qint64 AdaptiveRateController::msUntilToken(qint64 nowMs) const
+{
+    if (opt_.globalMaxPps <= 0.0 || tokensAtMs_ < 0)
+        return 0;
+
+    const double burst = qMax(1.0, opt_.globalMaxPps);
+    const double now = qMin(burst, tokens_ + (nowMs - tokensAtMs_) / 1000.0 * opt_.globalMaxPps);
+    if (now >= 1.0)
+        return 0;
+    return static_cast<qint64>(std::ceil((1.0 - now) / opt_.globalMaxPps * 1000.0));
+}
+
+void AdaptiveRateController::markSent(int targetId, qint64 nowMs)
+{
+    auto it = targets_.find(targetId);
+    if (it == targets_.end()) return;
+    it->inFlight = true;
+    it->lastSentMs = nowMs;
+}
+
+ProbeVerdict AdaptiveRateController::onResult(int targetId, bool replied, double rttMs)
+{
+    auto it = targets_.find(targetId);
+    if (it == targets_.end()) return ProbeVerdict::Warmup;
+    Target& t = *it;
+    t.inFlight = false;
+
+    // Without a valid RTT there is nothing to build a baseline from.
+    if (rttMs < 0.0)
+        replied = false;
+
+    ProbeVerdict v = ProbeVerdict::Stable;
+    if (!replied)
+    {
+        v = ProbeVerdict::Loss;
+    }
+    else if (t.samples < kWarmupSamples)
+    {
+        v = ProbeVerdict::Warmup;
+    }
+    else
+    {
+        const double band = qMax(opt_.rttChangeFloorMs, opt_.rttChangeFactor * t.rttVarMs);
+        if (std::fabs(rttMs - t.srttMs) > band)
+            v = ProbeVerdict::Changed;
+    }
+
+    if (replied)
+    {
+        // Same smoothing as TCP's RTO estimator (RFC 6298).
+        if (t.samples == 0)
+        {
+            t.srttMs = rttMs;
+            t.rttVarMs = rttMs / 2.0;
+        }
+        else
+        {
+            t.rttVarMs = 0.75 * t.rttVarMs + 0.25 * std::fabs(t.srttMs - rttMs);
+            t.srttMs = 0.875 * t.srttMs + 0.125 * rttMs;
+        }
+        ++t.samples;
+    }
+
+    if (v == ProbeVerdict::Stable)
+    {
+        if (++t.stableStreak >= opt_.stableProbesToBackoff)
+        {
+            t.stableStreak = 0;
+            t.intervalSec = qMin(opt_.maxIntervalSec, t.intervalSec * opt_.backoffFactor);
+        }
+    }
+    else
+    {
+        t.stableStreak = 0;
+        t.intervalSec = opt_.minIntervalSec;
+    }
+
+    t.nextDueMs = t.lastSentMs + static_cast<qint64>(effectiveInterval(t) * 1000.0);
+    return v;
+}
+
+qint64 AdaptiveRateController::nextDueMs(int targetId) const
+{
+    const auto it = targets_.constFind(targetId);
+    return it == targets_.constEnd() ? -1 : it->nextDueMs;
+}
+
+double AdaptiveRateController::intervalSec(int targetId) const
+{
+    const auto it = targets_.constFind(targetId);
+    return it == targets_.constEnd() ? -1.0 : effectiveInterval(*it);
+}
+
+qint64 AdaptiveRateController::nextWakeMs() const
+{
+    qint64 wake = -1;
+    for (const auto& t : targets_)
+    {
+        if (t.inFlight) continue;
+        if (wake < 0 || t.nextDueMs < wake) wake = t.nextDueMs;
+    }
+    return wake;
+}
+
+const char* AdaptiveRateController::verdictName(ProbeVerdict v)
+{
+    switch (v)
+    {
+    case ProbeVerdict::Warmup: return "warm-up";
+    case ProbeVerdict::Stable: return "stable";
+    case ProbeVerdict::Changed: return "rtt change";
+    case ProbeVerdict::Loss: return "loss";
+    }
+    return "?";
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include <QHash>
+#include <QVector>
+#include <QtGlobal>
+
+struct AdaptiveRateOptions
+{
+    double minIntervalSec = 1.0;    // fast probing: warm-up and after loss / RTT change
+    double maxIntervalSec = 60.0;   // fully backed off
+    double backoffFactor = 2.0;     // interval growth per stable streak
+    int stableProbesToBackoff = 4;  // consecutive stable probes per backoff step
+    double rttChangeFactor = 4.0;   // |rtt - srtt| above factor * rttvar ...
+    double rttChangeFloorMs = 5.0;  // ... and above this is a latency change
+    double perTargetMaxPps = 1.0;   // hard cap per target
+    double globalMaxPps = 50.0;     // across all targets (token bucket)
+};
+
+enum class ProbeVerdict
+{
+    Warmup,   // building the RTT baseline
+    Stable,
+    Changed,  // RTT moved outside the expected band
+    Loss
+};
+
+// Per-target probe scheduling. A target starts at the minimum interval,
+// backs off while RTT and loss stay within their usual band, and snaps back
+// to fast probing on loss or a latency change. Pure bookkeeping: callers pass
+// in the current time in ms, so it can run in any loop (or a test).
+class AdaptiveRateController
+{
+public:
+    explicit AdaptiveRateController(const AdaptiveRateOptions& opt = AdaptiveRateOptions());
+
+    void setOptions(const AdaptiveRateOptions& opt);
+    const AdaptiveRateOptions& options() const { return opt_; }
+
+    void addTarget(int targetId, qint64 nowMs);
+    void removeTarget(int targetId);
+    void clear();
+
+    // Targets whose next probe is due, earliest first.
+    QVector<int> dueTargets(qint64 nowMs) const;
+
+    // Consumes a token from the global budget; false if it is exhausted.
+    bool tryAcquire(qint64 nowMs);
+    qint64 msUntilToken(qint64 nowMs) const;
+
+    void markSent(int targetId, qint64 nowMs);
+    // A reply with rttMs < 0 counts as loss.
+    ProbeVerdict onResult(int targetId, bool replied, double rttMs);
+
+    qint64 nextDueMs(int targetId) const;
+    double intervalSec(int targetId) const;
+    // Earliest due time of any target not currently in flight; -1 if none.
+    qint64 nextWakeMs() const;
+
+    static const char* verdictName(ProbeVerdict v);
+
+private:
+    struct Target
+    {
+        double intervalSec = 1.0;
+        double srttMs = -1.0;
+        double rttVarMs = 0.0;
+        int samples = 0;
+        int stableStreak = 0;
+        qint64 lastSentMs = 0;
+        qint64 nextDueMs = 0;
+        bool inFlight = false;
+    };
+
+    double effectiveInterval(const Target& t) const;
+    void refill(qint64 nowMs);
+
+    AdaptiveRateOptions opt_;
+    QHash<int, Target> targets_;
+    double tokens_ = 0.0;
+    qint64 tokensAtMs_ = -1;
+};
@@ -0,0 +1,381 @@
+#include "DualStackConnector.h"
+
+#include <QDnsLookup>
+#include <QHostInfo>
+#include <QTcpSocket>
+
+#include <utility>
+
+const RaceAttempt* RaceResult::bestAttempt(QAbstractSocket::NetworkLayerProtocol family) const
+{
+    const RaceAttempt* best = nullptr;
+    for (const auto& a : attempts)
+    {
+        if (a.address.protocol() != family || !a.done) continue;
+        if (!best
+            || (a.ok && !best->ok)
+            || (a.ok && best->ok && a.connectMs < best->connectMs))
+            best = &a;
+    }
+    return best;
+}
+
+DualStackConnector::DualStackConnector(QObject* parent)
+    : QObject(parent)
+{
+    resolutionDelay_.setSingleShot(true);
+    attemptDelay_.setSingleShot(true);
+    timeout_.setSingleShot(true);
+    connect(&resolutionDelay_, &QTimer::timeout, this, &DualStackConnector::beginAttempts);
+    connect(&attemptDelay_, &QTimer::timeout, this, &DualStackConnector::startNextAttempt);
+    connect(&timeout_, &QTimer::timeout, this, &DualStackConnector::onTimeout);
+}
+
+DualStackConnector::~DualStackConnector()
+{
+    stopAll();
+}
+
+double DualStackConnector::elapsedMs() const
+{
+    return static_cast<double>(clock_.nsecsElapsed()) / 1e6;
+}
+
+void DualStackConnector::start(const QString& host, quint16 port)
+{
+    stopAll();
+    qDeleteAll(sockets_);
+    sockets_.clear();
+
+    host_ = host.trimmed();
+    port_ = port;
+    result_ = RaceResult();
+    v4_.clear();
+    v6_.clear();
+    aDone_ = aaaaDone_ = false;
+    fallbackStarted_ = false;
+    attemptsStarted_ = false;
+    preferV6Next_ = true;
+    done_ = false;
+
+    clock_.start();
+    timeout_.start(timeoutMs_);
+
+    // Literal addresses need no resolution and have only one family.
+    QHostAddress literal;
+    if (literal.setAddress(host_))
+    {
+        if (literal.protocol() == QAbstractSocket::IPv6Protocol) v6_ << literal;
+        else v4_ << literal;
+        aDone_ = aaaaDone_ = true;
+        beginAttempts();
+        return;
+    }
+
+    lookupA_ = new QDnsLookup(QDnsLookup::A, host_, this);
+    lookupAaaa_ = new QDnsLookup(QDnsLookup::AAAA, host_, this);
+
+    connect(lookupA_, &QDnsLookup::finished, this, [this]()
+    {
+        QList<QHostAddress> addrs;
+        for (const auto& rec : lookupA_->hostAddressRecords())
+            addrs << rec.value();
+        if (!addrs.isEmpty()) result_.resolveAMs = elapsedMs();
+        onResolved(QAbstractSocket::IPv4Protocol, addrs);
+    });
+    connect(lookupAaaa_, &QDnsLookup::finished, this, [this]()
+    {
+        QList<QHostAddress> addrs;
+        for (const auto& rec : lookupAaaa_->hostAddressRecords())
+            addrs << rec.value();
+        if (!addrs.isEmpty()) result_.resolveAaaaMs = elapsedMs();
+        onResolved(QAbstractSocket::IPv6Protocol, addrs);
+    });
+
+    lookupAaaa_->lookup();
+    lookupA_->lookup();
+}
+
+void DualStackConnector::abort()
+{
+    stopAll();
+}
+
+void DualStackConnector::onResolved(QAbstractSocket::NetworkLayerProtocol family, const QList<QHostAddress>& addrs)
+{
+    if (done_) return;
+
+    if (family == QAbstractSocket::IPv6Protocol)
+    {
+        aaaaDone_ = true;
+        v6_ += addrs;
+    }
+    else
+    {
+        aDone_ = true;
+        v4_ += addrs;
+    }
+
+    if (!attemptsStarted_)
+    {
+        if (aDone_ && aaaaDone_)
+        {
+            // QDnsLookup bypasses the hosts file; let the system resolver try.
+            if (v4_.isEmpty() && v6_.isEmpty()) fallbackResolve();
+            else beginAttempts();
+        }
+        else if (!addrs.isEmpty())
+        {
+            // AAAA first: go now. A first: give AAAA a short head start.
+            if (family == QAbstractSocket::IPv6Protocol) beginAttempts();
+            else resolutionDelay_.start(resolutionDelayMs_);
+        }
+        return;
+    }
+
+    // Late answer while attempts are already running: the new addresses join
+    // the staggered schedule. If the attempt delay has already expired, start
+    // one now even though an earlier attempt (maybe blackholed) is pending.
+    if (result_.winner < 0)
+    {
+        if (!attemptDelay_.isActive())
+            startNextAttempt();
+    }
+    else if (measureLoser_)
+    {
+        launchLoserProbe();
+    }
+    checkFinished();
+}
+
+void DualStackConnector::fallbackResolve()
+{
+    if (fallbackStarted_) return;
+    fallbackStarted_ = true;
+
+    QHostInfo::lookupHost(host_, this, [this](const QHostInfo& info)
+    {
+        if (done_) return;
+
+        for (const auto& addr : info.addresses())
+        {
+            if (addr.protocol() == QAbstractSocket::IPv6Protocol) v6_ << addr;
+            else v4_ << addr;
+        }
+
+        if (v4_.isEmpty() && v6_.isEmpty())
+        {
+            result_.error = (info.error() != QHostInfo::NoError) ? info.errorString() : QString("no addresses");
+            finish();
+            return;
+        }
+        beginAttempts();
+    });
+}
+
+void DualStackConnector::beginAttempts()
+{
+    if (attemptsStarted_ || done_) return;
+    attemptsStarted_ = true;
+    resolutionDelay_.stop();
+    startNextAttempt();
+}
+
+bool DualStackConnector::takeNextAddress(QHostAddress& out)
+{
+    QList<QHostAddress>* first = preferV6Next_ ? &v6_ : &v4_;
+    QList<QHostAddress>* second = preferV6Next_ ? &v4_ : &v6_;
+    if (first->isEmpty()) std::swap(first, second);
+    if (first->isEmpty()) return false;
+
+    out = first->takeFirst();
+    preferV6Next_ = (out.protocol() != QAbstractSocket::IPv6Protocol);
+    return true;
+}
+
+void DualStackConnector::startNextAttempt()
+{
+    if (done_ || result_.winner >= 0) return;
+
+    QHostAddress addr;
+    if (!takeNextAddress(addr))
+    {
+        checkFinished();
+        return;
+    }
+
+    launchAttempt(addr);
+    attemptDelay_.start(attemptDelayMs_);
+}
+
+void DualStackConnector::launchAttempt(const QHostAddress& addr)
+{
+    RaceAttempt a;
+    a.address = addr;
+    a.startOffsetMs = elapsedMs();
+    const int index = result_.attempts.size();
+    result_.attempts << a;
+
+    auto* sock = new QTcpSocket(this);
+    sockets_ << sock;
+
+    connect(sock, &QTcpSocket::connected, this, [this, index]()
+    {
+        onAttemptDone(index, true, QString());
+    });
+    connect(sock, &QTcpSocket::errorOccurred, this, [this, index, sock](QAbstractSocket::SocketError)
+    {
+        onAttemptDone(index, false, sock->errorString());
+    });
+
+    sock->connectToHost(addr, port_);
+}
+
+// After a winner, make sure the other family got at least one attempt.
+void DualStackConnector::launchLoserProbe()
+{
+    if (done_ || result_.winner < 0) return;
+
+    const auto winFamily = result_.attempts[result_.winner].address.protocol();
+    for (const auto& a : result_.attempts)
+    {
+        if (a.address.protocol() != winFamily)
+            return;
+    }
+
+    QList<QHostAddress>& other = (winFamily == QAbstractSocket::IPv6Protocol) ? v4_ : v6_;
+    if (!other.isEmpty())
+        launchAttempt(other.takeFirst());
+}
+
+void DualStackConnector::onAttemptDone(int index, bool ok, const QString& error)
+{
+    if (done_ || index >= result_.attempts.size() || result_.attempts[index].done) return;
+
+    RaceAttempt& a = result_.attempts[index];
+    a.done = true;
+    a.ok = ok;
+    a.error = error;
+    a.connectMs = elapsedMs() - a.startOffsetMs;
+
+    QTcpSocket* sock = sockets_[index];
+    QObject::disconnect(sock, nullptr, this, nullptr);
+
+    if (ok && result_.winner < 0)
+    {
+        result_.winner = index;
+        result_.ok = true;
+        result_.totalMs = elapsedMs();
+        attemptDelay_.stop();
+
+        const RaceAttempt winner = a;
+        emit winnerConnected(sock, winner);
+        if (done_) return; // aborted from the handler
+
+        sock->disconnectFromHost();
+        if (measureLoser_) launchLoserProbe();
+    }
+    else if (ok)
+    {
+        sock->disconnectFromHost();
+    }
+    else
+    {
+        sock->abort();
+        // A failure starts the next attempt right away (RFC 8305, 5).
+        if (result_.winner < 0)
+        {
+            attemptDelay_.stop();
+            startNextAttempt();
+        }
+    }
+
+    checkFinished();
+}
+
+void DualStackConnector::onTimeout()
+{
+    if (done_) return;
+
+    for (int i = 0; i < result_.attempts.size(); ++i)
+    {
+        RaceAttempt& a = result_.attempts[i];
+        if (a.done) continue;
+        a.done = true;
+        a.error = "timed out";
+        a.connectMs = elapsedMs() - a.startOffsetMs;
+        QObject::disconnect(sockets_[i], nullptr, this, nullptr);
+        sockets_[i]->abort();
+    }
+    if (!result_.ok && result_.error.isEmpty())
+        result_.error = "timed out";
+    finish();
+}
+
+bool DualStackConnector::attemptInFlight() const
+{
+    for (const auto& a : result_.attempts)
+    {
+        if (!a.done) return true;
+    }
+    return false;
+}
+
+void DualStackConnector::checkFinished()
+{
+    if (done_ || attemptInFlight()) return;
+
+    const bool resolving = !(aDone_ && aaaaDone_) && !fallbackStarted_;
+    if (result_.winner < 0)
+    {
+        if (!v4_.isEmpty() || !v6_.isEmpty() || resolving) return;
+    }
+    else if (measureLoser_ && resolving)
+    {
+        return;
+    }
+
+    if (!result_.ok && result_.error.isEmpty())
+    {
+        result_.error = result_.attempts.isEmpty() ? QString("no addresses") : result_.attempts.last().error;
+    }
+    finish();
+}
+
+void DualStackConnector::finish()
+{
+    if (done_) return;
+    stopAll();
+    emit finished(result_);
+}
+
+void DualStackConnector::stopAll()
+{
+    done_ = true;
+    resolutionDelay_.stop();
+    attemptDelay_.stop();
+    timeout_.stop();
+
+    if (lookupA_)
+    {
+        lookupA_->disconnect(this);
+        lookupA_->abort();
+        lookupA_->deleteLater();
+        lookupA_ = nullptr;
+    }
+    if (lookupAaaa_)
+    {
+        lookupAaaa_->disconnect(this);
+        lookupAaaa_->abort();
+        lookupAaaa_->deleteLater();
+        lookupAaaa_ = nullptr;
+    }
+
+    for (QTcpSocket* sock : sockets_)
+    {
+        QObject::disconnect(sock, nullptr, this, nullptr);
+        if (sock->state() != QAbstractSocket::UnconnectedState
+            && sock->state() != QAbstractSocket::ClosingState)
+            sock->abort();
+    }
+}
@@ -0,0 +1,104 @@
+#pragma once
+#include <QAbstractSocket>
+#include <QElapsedTimer>
+#include <QHostAddress>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <QVector>
+
+class QDnsLookup;
+class QTcpSocket;
+
+struct RaceAttempt
+{
+    QHostAddress address;
+    double startOffsetMs = 0.0;  // relative to the start of the race
+    double connectMs = -1.0;     // attempt start -> connected/failed
+    bool done = false;
+    bool ok = false;
+    QString error;
+};
+
+struct RaceResult
+{
+    bool ok = false;
+    QString error;
+    double resolveAMs = -1.0;     // -1 if not resolved via DNS (literal, fallback, failure)
+    double resolveAaaaMs = -1.0;
+    double totalMs = -1.0;        // race start -> winner connected
+    int winner = -1;              // index into attempts
+    QVector<RaceAttempt> attempts;
+
+    // Fastest successful attempt of a family, else its first failed one.
+    const RaceAttempt* bestAttempt(QAbstractSocket::NetworkLayerProtocol family) const;
+};
+
+// RFC 8305 ("Happy Eyeballs v2") TCP connect: A and AAAA are resolved in
+// parallel, attempts alternate families starting with IPv6 and are staggered
+// by the attempt delay. Unlike a browser, the race keeps going after a winner
+// until the other family has also answered, so both latencies are reported.
+class DualStackConnector final : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit DualStackConnector(QObject* parent = nullptr);
+    ~DualStackConnector() override;
+
+    void setResolutionDelayMs(int ms) { resolutionDelayMs_ = ms; }
+    void setAttemptDelayMs(int ms) { attemptDelayMs_ = ms; }
+    void setTimeoutMs(int ms) { timeoutMs_ = ms; }
+    void setMeasureLoser(bool on) { measureLoser_ = on; }
+
+    void start(const QString& host, quint16 port);
+    void abort();
+
+signals:
+    // The socket is connected and stays valid until the handler returns.
+    void winnerConnected(QTcpSocket* socket, const RaceAttempt& attempt);
+    void finished(const RaceResult& result);
+
+private:
+    void onResolved(QAbstractSocket::NetworkLayerProtocol family, const QList<QHostAddress>& addrs);
+    void fallbackResolve();
+    void beginAttempts();
+    bool takeNextAddress(QHostAddress& out);
+    void startNextAttempt();
+    void launchAttempt(const QHostAddress& addr);
+    void launchLoserProbe();
+    void onAttemptDone(int index, bool ok, const QString& error);
+    void onTimeout();
+    void checkFinished();
+    void finish();
+    void stopAll();
+    bool attemptInFlight() const;
+    double elapsedMs() const;
+
+    QString host_;
+    quint16 port_ = 0;
+    int resolutionDelayMs_ = 50;
+    int attemptDelayMs_ = 250;
+    int timeoutMs_ = 5000;
+    bool measureLoser_ = true;
+
+    QElapsedTimer clock_;
+    QTimer resolutionDelay_;
+    QTimer attemptDelay_;
+    QTimer timeout_;
+    QDnsLookup* lookupA_ = nullptr;
+    QDnsLookup* lookupAaaa_ = nullptr;
+
+    QList<QHostAddress> v4_;
+    QList<QHostAddress> v6_;
+    bool aDone_ = false;
+    bool aaaaDone_ = false;
+    bool fallbackStarted_ = false;
+    bool attemptsStarted_ = false;
+    bool preferV6Next_ = true;
+    bool done_ = true;
+
+    RaceResult result_;
+    QVector<QTcpSocket*> sockets_;  // parallel to result_.attempts
+};
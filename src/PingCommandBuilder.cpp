@@ -20,6 +20,14 @@ static bool isMac()
 #endif
 }
 
+// Only an explicit family is forced; otherwise the system picks, as it
+// does for a plain "ping host".
+static void addFamily(QStringList& args, AddressFamily family)
+{
+    if (family == AddressFamily::IPv4) args << "-4";
+    else if (family == AddressFamily::IPv6) args << "-6";
+}
+
 Command PingCommandBuilder::buildPing(const QString& host, const PingOptions& opt)
 {
     Command c;
@@ -31,8 +39,7 @@ Command PingCommandBuilder::buildPing(const QString& host, const PingOptions& op
     {
         // Windows ping:
         //  -n <count>, -t (continuous), -w <timeout_ms>, -l <size>, -4 / -6
-        if (opt.ipv6) c.args << "-6";
-        else c.args << "-4";
+        addFamily(c.args, opt.family);
 
         if (opt.count <= 0) c.args << "-t";
         else c.args << "-n" << QString::number(opt.count);
@@ -47,11 +54,16 @@ Command PingCommandBuilder::buildPing(const QString& host, const PingOptions& op
         // Linux/macOS ping:
         //  -c <count>, (no count => continuous), -W <timeout>, -i <interval>, -s <size>, -4/-6
         // Note: exact meaning of -W differs a bit across platforms; best effort.
-        if (opt.ipv6) c.args << "-6";
-        else c.args << "-4";
+        addFamily(c.args, opt.family);
 
         if (opt.count > 0) c.args << "-c" << QString::number(opt.count);
 
+#ifdef Q_OS_LINUX
+        // Report each unanswered probe ("no answer yet for icmp_seq=N");
+        // macOS prints "Request timeout" lines by default.
+        c.args << "-O";
+#endif
+
         // timeout: prefer whole seconds for -W where required
         int timeoutSec = qMax(1, (opt.timeoutMs + 999) / 1000);
         c.args << "-W" << QString::number(timeoutSec);
@@ -68,22 +80,23 @@ Command PingCommandBuilder::buildPing(const QString& host, const PingOptions& op
     return c;
 }
 
-Command PingCommandBuilder::buildTraceroute(const QString& host, bool ipv6)
+Command PingCommandBuilder::buildTraceroute(const QString& host, AddressFamily family)
 {
     Command c;
     if (isWindows())
     {
+        // -d: numeric only; hop names are resolved afterwards, in parallel.
         c.program = "tracert";
-        if (ipv6) c.args << "-6";
-        else c.args << "-4";
+        addFamily(c.args, family);
+        c.args << "-d";
         c.args << host.trimmed();
         return c;
     }
 
     // Linux/macOS
     c.program = "traceroute";
-    if (ipv6) c.args << "-6";
-    else c.args << "-4";
+    addFamily(c.args, family);
+    c.args << "-n";
     c.args << host.trimmed();
     return c;
 }
@@ -2,13 +2,21 @@
 #include <QString>
 #include <QStringList>
 
+enum class AddressFamily
+{
+    Any,        // whatever the system resolver returns first
+    IPv4,
+    IPv6,
+    DualStack   // race both (RFC 8305)
+};
+
 struct PingOptions
 {
     int count = 4;              // 0 => continuous
     int timeoutMs = 1000;       // per-packet timeout (best effort across OS)
     double intervalSec = 1.0;   // best effort; may be ignored on Windows
     int payloadBytes = 32;      // ICMP payload size (best effort)
-    bool ipv6 = false;
+    AddressFamily family = AddressFamily::Any;  // Any: no -4/-6; DualStack is run as two jobs
 };
 
 struct Command
@@ -21,5 +29,5 @@ class PingCommandBuilder
 {
 public:
     static Command buildPing(const QString& host, const PingOptions& opt);
-    static Command buildTraceroute(const QString& host, bool ipv6);
+    static Command buildTraceroute(const QString& host, AddressFamily family);
 };
@@ -95,6 +95,55 @@ PingStats PingOutputParser::parse(const QString& fullText)
     return s;
 }
 
+bool PingOutputParser::parseProbeLine(const QString& line, PingReply* reply)
+{
+    // Unix: "64 bytes from 8.8.8.8: icmp_seq=1 ttl=117 time=12.3 ms"
+    // Windows: "Reply from 8.8.8.8: bytes=32 time=12ms TTL=117" or "time<1ms"
+    static const QRegularExpression reUnix(R"(bytes\s+from\s+.*\bicmp_seq=(\d+).*\btime=([0-9.]+)\s*ms)",
+                                           QRegularExpression::CaseInsensitiveOption);
+    static const QRegularExpression reWin(R"(^\s*Reply\s+from\s+.*\btime([=<])([0-9.]+)\s*ms)",
+                                          QRegularExpression::CaseInsensitiveOption);
+    // Linux -O: "no answer yet for icmp_seq=3"; macOS: "Request timeout for icmp_seq 3"
+    static const QRegularExpression reUnixLoss(R"(^\s*(?:no\s+answer\s+yet|Request\s+timeout)\s+for\s+icmp_seq[=\s]+(\d+))",
+                                               QRegularExpression::CaseInsensitiveOption);
+    // Windows: "Request timed out." or "Reply from 10.0.0.1: Destination host unreachable."
+    static const QRegularExpression reWinLoss(R"(^\s*(?:Request\s+timed\s+out|Reply\s+from\s+.*:\s*Destination\s+\w+\s+unreachable))",
+                                              QRegularExpression::CaseInsensitiveOption);
+
+    // A duplicate answers a probe that was already counted.
+    if (line.contains("DUP!"))
+        return false;
+
+    auto m = reUnix.match(line);
+    if (m.hasMatch())
+    {
+        reply->replied = true;
+        reply->seq = m.captured(1).toInt();
+        reply->rttMs = m.captured(2).toDouble();
+        reply->rttBelow = false;
+        return true;
+    }
+
+    m = reWin.match(line);
+    if (m.hasMatch())
+    {
+        reply->replied = true;
+        reply->seq = -1;
+        reply->rttMs = m.captured(2).toDouble();
+        reply->rttBelow = m.captured(1) == "<";
+        return true;
+    }
+
+    *reply = PingReply();
+    m = reUnixLoss.match(line);
+    if (m.hasMatch())
+    {
+        reply->seq = m.captured(1).toInt();
+        return true;
+    }
+    return reWinLoss.match(line).hasMatch();
+}
+
 int PingOutputParser::countRepliesInChunk(const QString& chunk)
 {
     // Heuristic: count lines that look like replies.
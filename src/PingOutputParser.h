@@ -16,12 +16,25 @@ struct PingStats
     double rttMdevMs = -1.0; // Linux: mdev; Windows: not provided
 };
 
+// Outcome of one probe, as printed by ping.
+struct PingReply
+{
+    bool replied = false;  // false: timed out or answered with an error
+    int seq = -1;          // icmp_seq; -1 where ping does not print it (Windows)
+    double rttMs = -1.0;
+    bool rttBelow = false; // Windows "time<1ms": rttMs is an upper bound
+};
+
 class PingOutputParser
 {
 public:
     // Parse the *final* output text from system ping.
     static PingStats parse(const QString& fullText);
 
+    // Parse one line of output; false unless it reports a reply with a time
+    // or a probe that went unanswered (Linux needs -O to print those).
+    static bool parseProbeLine(const QString& line, PingReply* reply);
+
     // Lightweight heuristic to count "reply" lines for progress.
     static int countRepliesInChunk(const QString& chunk);
 };
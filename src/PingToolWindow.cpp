@@ -1,6 +1,4 @@
 #include "PingToolWindow.h"
-#include "PingCommandBuilder.h"
-#include "PingOutputParser.h"
 
 #include <QApplication>
 #include <QClipboard>
@@ -9,7 +7,6 @@
 #include <QFile>
 #include <QFileDialog>
 #include <QGroupBox>
-#include <QHostInfo>
 #include <QHBoxLayout>
 #include <QLabel>
 #include <QLineEdit>
@@ -17,12 +14,13 @@
 #include <QProgressBar>
 #include <QPushButton>
 #include <QSpinBox>
-#include <QTcpSocket>
 #include <QTextEdit>
 #include <QVBoxLayout>
 #include <QWidget>
 #include <QCheckBox>
+#include <QComboBox>
 #include <QRegularExpression>
+#include <QSignalBlocker>
 #include <QTextCursor>
 
 static QString nowStamp()
@@ -30,6 +28,129 @@ static QString nowStamp()
     return QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss");
 }
 
+static QString formatUs(qint64 us)
+{
+    return QString::number(static_cast<double>(us) / 1000.0, 'f', 3);
+}
+
+static QString formatTcpInfo(const TcpInfoSample& ki)
+{
+    QString s = "kernel srtt " + formatUs(ki.srttUs) + " ms";
+    if (ki.rttVarUs >= 0) s += ", rttvar " + formatUs(ki.rttVarUs) + " ms";
+    if (ki.minRttUs >= 0) s += ", min " + formatUs(ki.minRttUs) + " ms";
+    if (ki.retransmits >= 0) s += ", retrans " + QString::number(ki.retransmits);
+    return s;
+}
+
+static QString familyName(const QHostAddress& addr)
+{
+    return addr.protocol() == QAbstractSocket::IPv6Protocol ? "IPv6" : "IPv4";
+}
+
+static QString formatRace(const RaceResult& race)
+{
+    if (race.winner < 0)
+        return QString();
+
+    const RaceAttempt& w = race.attempts[race.winner];
+    const auto loserFamily = (w.address.protocol() == QAbstractSocket::IPv6Protocol)
+        ? QAbstractSocket::IPv4Protocol : QAbstractSocket::IPv6Protocol;
+    const QString loserName = (loserFamily == QAbstractSocket::IPv6Protocol) ? "IPv6" : "IPv4";
+
+    QString s = familyName(w.address) + " won";
+    if (const RaceAttempt* l = race.bestAttempt(loserFamily))
+    {
+        if (l->ok)
+            s += ", " + loserName + " " + QString::number(l->connectMs, 'f', 3) + " ms";
+        else
+            s += ", " + loserName + " failed (" + l->error + ")";
+    }
+    else
+    {
+        s += ", no " + loserName + " address";
+    }
+    return s;
+}
+
+static QString formatStats(const PingStats& st)
+{
+    QString s = st.hasPacketStats
+        ? QString("sent %1, recv %2, loss %3%").arg(st.sent).arg(st.received).arg(st.lossPct, 0, 'f', 1)
+        : QString("no packet stats");
+    if (st.hasRtt)
+    {
+        s += QString(", rtt min/avg/max %1/%2/%3 ms")
+            .arg(st.rttMinMs, 0, 'f', 3)
+            .arg(st.rttAvgMs, 0, 'f', 3)
+            .arg(st.rttMaxMs, 0, 'f', 3);
+    }
+    return s;
+}
+
+// No PTR record: show the address itself once the lookup has finished.
+static QString hopName(const TraceHop& h)
+{
+    if (h.address.isEmpty()) return QString();
+    if (!h.resolved) return QString("(resolving...)");
+    return h.hostName.isEmpty() ? h.address : h.hostName;
+}
+
+static QString formatHopTable(const QString& tag, const QVector<TraceHop>& hops)
+{
+    QString s = "\n" + tag + QString("%1  %2  %3  %4\n")
+        .arg(QString("Hop"), 3).arg(QString("Address"), -39).arg(QString("RTT (ms)"), -26).arg(QString("Name"));
+
+    for (const auto& h : hops)
+    {
+        QStringList rtts;
+        for (int i = 0; i < h.rttMs.size(); ++i)
+        {
+            const double v = h.rttMs[i];
+            if (v < 0.0) rtts << QString("*");
+            else if (h.rttBelow.value(i)) rtts << "<" + QString::number(v);
+            else rtts << QString::number(v, 'f', 3);
+        }
+
+        s += tag + QString("%1  %2  %3  %4\n")
+            .arg(h.hop, 3)
+            .arg(h.address.isEmpty() ? QString("*") : h.address, -39)
+            .arg(rtts.join(' '), -26)
+            .arg(hopName(h));
+    }
+    return s;
+}
+
+static QString formatBitRate(double bps)
+{
+    if (bps >= 1e9) return QString::number(bps / 1e9, 'f', 2) + " Gbit/s";
+    if (bps >= 1e6) return QString::number(bps / 1e6, 'f', 2) + " Mbit/s";
+    return QString::number(bps / 1e3, 'f', 1) + " Kbit/s";
+}
+
+static QString formatThroughput(const QString& tag, const ThroughputInterval& iv)
+{
+    QString s = QString("[%1] %2-%3 s  %4")
+        .arg(tag)
+        .arg(iv.startSec, 5, 'f', 1)
+        .arg(iv.endSec, 5, 'f', 1)
+        .arg(formatBitRate(iv.bitsPerSec));
+
+    if (iv.retransmits >= 0)
+        s += QString("  retr %1").arg(iv.retransmits);
+    if (iv.cpuPct >= 0.0)
+        s += QString("  cpu %1%").arg(iv.cpuPct, 0, 'f', 0);
+
+    const double wall = iv.endSec - iv.startSec;
+    if (iv.streamBytes.size() > 1 && wall > 0.0)
+    {
+        QStringList per;
+        for (qint64 b : iv.streamBytes)
+            per << QString::number(static_cast<double>(b) * 8.0 / wall / 1e9, 'f', 2);
+        s += "  streams (Gbit/s): " + per.join(' ');
+    }
+    return s + "\n";
+}
+
 PingToolWindow::PingToolWindow()
 {
     setWindowTitle("Ping tool by charilog v1.0 (C++/Qt)");
@@ -51,12 +172,17 @@ PingToolWindow::PingToolWindow()
     traceBtn_ = new QPushButton("Traceroute", this);
     dnsBtn_ = new QPushButton("DNS", this);
     tcpBtn_ = new QPushButton("TCP Test", this);
+    tputBtn_ = new QPushButton("Throughput", this);
+    tputServerChk_ = new QCheckBox("Serve", this);
+    tputServerChk_->setToolTip("Accept throughput tests on the TCP port");
 
     topRow->addWidget(pingBtn_);
     topRow->addWidget(stopBtn_);
     topRow->addWidget(traceBtn_);
     topRow->addWidget(dnsBtn_);
     topRow->addWidget(tcpBtn_);
+    topRow->addWidget(tputBtn_);
+    topRow->addWidget(tputServerChk_);
 
     root->addLayout(topRow);
 
@@ -70,6 +196,14 @@ PingToolWindow::PingToolWindow()
 
     continuousChk_ = new QCheckBox("Continuous", this);
 
+    adaptiveChk_ = new QCheckBox("Adaptive", this);
+    adaptiveChk_->setEnabled(false);
+    adaptiveChk_->setToolTip("Continuous ping: back off stable hosts, probe fast on loss or latency change");
+
+    publishChk_ = new QCheckBox("Publish", this);
+    publishChk_->setToolTip(QString("Publish ping and TCP Test results to the shared-memory bus %1")
+        .arg(kResultBusDefaultName));
+
     timeoutSpin_ = new QSpinBox(this);
     timeoutSpin_->setRange(100, 60000);
     timeoutSpin_->setValue(1000);
@@ -84,15 +218,31 @@ PingToolWindow::PingToolWindow()
     payloadSpin_->setRange(0, 65000);
     payloadSpin_->setValue(32);
 
-    ipv6Chk_ = new QCheckBox("IPv6", this);
+    familyCombo_ = new QComboBox(this);
+    familyCombo_->addItem("Auto");
+    familyCombo_->addItem("IPv4");
+    familyCombo_->addItem("IPv6");
+    familyCombo_->addItem("Dual-stack");
+    familyCombo_->setToolTip("Auto: system default / whichever family the host resolves to\n"
+                             "Dual-stack: ping/traceroute both families side by side, race them for TCP Test");
 
     tcpPortSpin_ = new QSpinBox(this);
     tcpPortSpin_->setRange(1, 65535);
     tcpPortSpin_->setValue(443);
 
+    streamsSpin_ = new QSpinBox(this);
+    streamsSpin_->setRange(1, 32);
+    streamsSpin_->setValue(1);
+
+    durationSpin_ = new QSpinBox(this);
+    durationSpin_->setRange(1, 3600);
+    durationSpin_->setValue(10);
+
     opt->addWidget(new QLabel("Count:", this));
     opt->addWidget(countSpin_);
     opt->addWidget(continuousChk_);
+    opt->addWidget(adaptiveChk_);
+    opt->addWidget(publishChk_);
     opt->addSpacing(10);
     opt->addWidget(new QLabel("Timeout (ms):", this));
     opt->addWidget(timeoutSpin_);
@@ -100,10 +250,14 @@ PingToolWindow::PingToolWindow()
     opt->addWidget(intervalSpin_);
     opt->addWidget(new QLabel("Payload (B):", this));
     opt->addWidget(payloadSpin_);
-    opt->addWidget(ipv6Chk_);
+    opt->addWidget(familyCombo_);
     opt->addSpacing(10);
     opt->addWidget(new QLabel("TCP Port:", this));
     opt->addWidget(tcpPortSpin_);
+    opt->addWidget(new QLabel("Streams:", this));
+    opt->addWidget(streamsSpin_);
+    opt->addWidget(new QLabel("Duration (s):", this));
+    opt->addWidget(durationSpin_);
     opt->addStretch(1);
 
     root->addWidget(optBox);
@@ -152,14 +306,50 @@ PingToolWindow::PingToolWindow()
     connect(traceBtn_, &QPushButton::clicked, this, &PingToolWindow::onTracerouteClicked);
     connect(dnsBtn_, &QPushButton::clicked, this, &PingToolWindow::onDnsClicked);
     connect(tcpBtn_, &QPushButton::clicked, this, &PingToolWindow::onTcpTestClicked);
+    connect(tputBtn_, &QPushButton::clicked, this, &PingToolWindow::onThroughputClicked);
+    connect(tputServerChk_, &QCheckBox::toggled, this, &PingToolWindow::onThroughputServerToggled);
+    connect(continuousChk_, &QCheckBox::toggled, adaptiveChk_, &QCheckBox::setEnabled);
+    connect(publishChk_, &QCheckBox::toggled, this, &PingToolWindow::onPublishToggled);
     connect(clearBtn_, &QPushButton::clicked, this, &PingToolWindow::onClearClicked);
     connect(saveBtn_, &QPushButton::clicked, this, &PingToolWindow::onSaveClicked);
     connect(copyBtn_, &QPushButton::clicked, this, &PingToolWindow::onCopyClicked);
 
-    proc_.setProcessChannelMode(QProcess::MergedChannels);
-    connect(&proc_, &QProcess::readyRead, this, &PingToolWindow::onProcReadyRead);
-    connect(&proc_, &QProcess::finished, this, &PingToolWindow::onProcFinished);
-    connect(&proc_, &QProcess::errorOccurred, this, &PingToolWindow::onProcError);
+    connect(&engine_, &ProbeEngine::started, this, &PingToolWindow::onProbeStarted);
+    connect(&engine_, &ProbeEngine::output, this, &PingToolWindow::onProbeOutput);
+    connect(&engine_, &ProbeEngine::tcpSample, this, &PingToolWindow::onTcpSample);
+    connect(&engine_, &ProbeEngine::hopResolved, this, &PingToolWindow::onHopResolved);
+    connect(&engine_, &ProbeEngine::finished, this, &PingToolWindow::onProbeFinished);
+    connect(&engine_, &ProbeEngine::idle, this, &PingToolWindow::onEngineIdle);
+    connect(&monitor_, &AdaptiveMonitor::probeResult, this, &PingToolWindow::onAdaptiveResult);
+
+    connect(&tput_, &ThroughputClient::message, this, [this](const QString& text)
+    {
+        appendOutput(text + "\n");
+    });
+    connect(&tput_, &ThroughputClient::intervalReport, this, [this](const ThroughputInterval& iv)
+    {
+        appendOutput(formatThroughput("TX", iv));
+        updateProgress(false);
+    });
+    connect(&tput_, &ThroughputClient::finished, this, [this](const ThroughputInterval& total)
+    {
+        appendOutput(formatThroughput("TX total", total));
+        setRunning(false);
+        statusLabel_->setText("Done");
+    });
+
+    connect(&tputServer_, &ThroughputServer::message, this, [this](const QString& text)
+    {
+        appendOutput(text + "\n");
+    });
+    connect(&tputServer_, &ThroughputServer::intervalReport, this, [this](const ThroughputInterval& iv)
+    {
+        appendOutput(formatThroughput("RX", iv));
+    });
+    connect(&tputServer_, &ThroughputServer::finished, this, [this](const ThroughputInterval& total)
+    {
+        appendOutput(formatThroughput("RX total", total));
+    });
 }
 
 QStringList PingToolWindow::splitHosts(const QString& input) const
@@ -186,6 +376,7 @@ void PingToolWindow::setRunning(bool running)
     traceBtn_->setEnabled(!running);
     dnsBtn_->setEnabled(!running);
     tcpBtn_->setEnabled(!running);
+    tputBtn_->setEnabled(!running);
     stopBtn_->setEnabled(running);
     progress_->setVisible(running);
     if (!running) progress_->setValue(0);
@@ -198,96 +389,176 @@ void PingToolWindow::appendOutput(const QString& text)
     output_->moveCursor(QTextCursor::End);
 }
 
-void PingToolWindow::startCommand(const QString& program, const QStringList& args, const QString& headerLine)
+bool PingToolWindow::isBusy() const
 {
-    fullText_.clear();
-    repliesSoFar_ = 0;
-
-    appendOutput("\n");
-    appendOutput("[" + nowStamp() + "] " + headerLine + "\n");
-    appendOutput("Command: " + program + " " + args.join(' ') + "\n\n");
-
-    currentProgram_ = program;
-    currentArgs_ = args;
+    return !engine_.isIdle() || tput_.isRunning() || monitor_.isRunning();
+}
 
-    proc_.start(program, args);
-    if (!proc_.waitForStarted(1500))
+AddressFamily PingToolWindow::selectedFamily() const
+{
+    switch (familyCombo_->currentIndex())
     {
-        setRunning(false);
-        statusLabel_->setText("Failed to start process");
-        appendOutput("ERROR: Could not start command.\n");
-        return;
+    case 1: return AddressFamily::IPv4;
+    case 2: return AddressFamily::IPv6;
+    case 3: return AddressFamily::DualStack;
+    default: return AddressFamily::Any;
     }
+}
 
-    setRunning(true);
-    statusLabel_->setText("Running...");
-    pktLabel_->setText("Packets: -");
-    rttLabel_->setText("RTT: -");
-
-    updateProgress(false);
+PingOptions PingToolWindow::currentPingOptions() const
+{
+    PingOptions opt;
+    opt.family = selectedFamily();
+    opt.payloadBytes = payloadSpin_->value();
+    opt.timeoutMs = timeoutSpin_->value();
+    opt.intervalSec = intervalSpin_->value();
+    opt.count = continuousChk_->isChecked() ? 0 : countSpin_->value();
+    return opt;
 }
 
 void PingToolWindow::onPingClicked()
 {
-    if (proc_.state() != QProcess::NotRunning)
+    if (isBusy())
         return;
 
-    hostQueue_ = splitHosts(hostEdit_->text());
-    if (hostQueue_.isEmpty())
+    const QStringList hosts = splitHosts(hostEdit_->text());
+    if (hosts.isEmpty())
     {
         QMessageBox::warning(this, "PingTool", "Please enter at least one host.");
         return;
     }
 
-    startNextHostIfAny();
-}
-
-void PingToolWindow::startNextHostIfAny()
-{
-    if (hostQueue_.isEmpty())
+    if (continuousChk_->isChecked() && adaptiveChk_->isChecked())
     {
-        setRunning(false);
-        statusLabel_->setText("Done");
+        startAdaptiveMonitor(hosts);
         return;
     }
 
-    const QString host = hostQueue_.takeFirst();
+    // Hosts are pinged in order; in dual-stack mode both families of a host
+    // run side by side.
+    const PingOptions opt = currentPingOptions();
+    const bool dual = (selectedFamily() == AddressFamily::DualStack);
+    engine_.setMaxConcurrent(dual ? 2 : 1);
+    for (const auto& host : hosts)
+    {
+        ProbeJob job;
+        job.kind = ProbeKind::Ping;
+        job.host = host;
+        job.ping = opt;
+        if (dual)
+        {
+            job.ping.family = AddressFamily::IPv4;
+            engine_.submit(job);
+            job.ping.family = AddressFamily::IPv6;
+        }
+        engine_.submit(job);
+    }
+    beginBatch(opt.count * static_cast<int>(hosts.size()) * (dual ? 2 : 1));
+}
 
-    PingOptions opt;
-    opt.ipv6 = ipv6Chk_->isChecked();
-    opt.payloadBytes = payloadSpin_->value();
-    opt.timeoutMs = timeoutSpin_->value();
-    opt.intervalSec = intervalSpin_->value();
-    opt.count = continuousChk_->isChecked() ? 0 : countSpin_->value();
+void PingToolWindow::beginBatch(int expectedReplies)
+{
+    repliesSoFar_ = 0;
+    totalExpectedReplies_ = qMax(0, expectedReplies);
+    setRunning(true);
+}
+
+void PingToolWindow::startAdaptiveMonitor(const QStringList& hosts)
+{
+    // Fast probing runs at twice the configured rate; stable hosts back off
+    // to 4x the configured interval. That still saves probes, and an outage
+    // on a quiet host is seen at most 4x later than with fixed probing.
+    const double interval = intervalSpin_->value();
+    AdaptiveRateOptions ro;
+    ro.minIntervalSec = qMax(0.2, interval / 2.0);
+    ro.maxIntervalSec = interval * 4.0;
+    ro.perTargetMaxPps = 1.0 / ro.minIntervalSec;
+    monitor_.setOptions(ro);
+
+    // Dual-stack has no single address to follow; it probes IPv4.
+    ProbeJob job;
+    job.kind = ProbeKind::Ping;
+    job.ping = currentPingOptions();
+    job.ping.count = 1;
+    if (job.ping.family == AddressFamily::DualStack)
+        job.ping.family = AddressFamily::IPv4;
+    monitor_.setProbeTemplate(job);
+
+    appendOutput(QString("\n[%1] Adaptive monitoring %2 host(s): interval %3-%4 s, budget %5 pps\n")
+        .arg(nowStamp()).arg(hosts.size())
+        .arg(ro.minIntervalSec, 0, 'f', 2).arg(ro.maxIntervalSec, 0, 'f', 1)
+        .arg(ro.globalMaxPps, 0, 'f', 0));
+    statusLabel_->setText("Adaptive monitoring...");
+    beginBatch(0);
+    monitor_.start(hosts);
+}
+
+void PingToolWindow::stopAdaptiveMonitor()
+{
+    const double elapsed = monitor_.elapsedSec();
+    const qint64 sent = monitor_.probesSent();
+    const qint64 fixed = static_cast<qint64>(elapsed / intervalSpin_->value()) * monitor_.targets().size();
+    const double worstSec = monitor_.options().maxIntervalSec;
+    monitor_.stop();
+
+    QString line = QString("[%1] Adaptive monitoring stopped: %2 probes in %3 s")
+        .arg(nowStamp()).arg(sent).arg(elapsed, 0, 'f', 1);
+    if (fixed > 0)
+    {
+        line += QString(" (fixed %1 s interval: %2, %3% saved)")
+            .arg(intervalSpin_->value(), 0, 'f', 2).arg(fixed)
+            .arg(100.0 * (fixed - sent) / fixed, 0, 'f', 1);
+    }
+    // A backed-off host is probed once per max interval, so that is how
+    // long an outage can go unnoticed.
+    line += QString(", outage seen within %1 s (fixed: %2 s)")
+        .arg(worstSec, 0, 'f', 1).arg(intervalSpin_->value(), 0, 'f', 1);
+    appendOutput(line + "\n");
 
-    totalExpectedReplies_ = (opt.count <= 0) ? 0 : opt.count;
+    setRunning(false);
+    statusLabel_->setText("Stopped");
+}
 
-    const Command cmd = PingCommandBuilder::buildPing(host, opt);
-    startCommand(cmd.program, cmd.args, "PING " + host);
+void PingToolWindow::onAdaptiveResult(const AdaptiveProbeReport& report)
+{
+    const QString rtt = report.replied
+        ? (report.rttMs >= 0 ? QString::number(report.rttMs, 'f', 3) + " ms" : QString("reply"))
+        : QString("timeout");
+    appendOutput(QString("[%1] %2: %3 (%4, next %5 s)\n")
+        .arg(nowStamp(), report.target, rtt, QString(AdaptiveRateController::verdictName(report.verdict)))
+        .arg(report.nextIntervalSec, 0, 'f', 1));
+    updateProgress(false);
 }
 
 void PingToolWindow::onStopClicked()
 {
-    if (proc_.state() == QProcess::NotRunning)
+    if (monitor_.isRunning())
     {
-        setRunning(false);
+        stopAdaptiveMonitor();
         return;
     }
 
-    appendOutput("\n[" + nowStamp() + "] STOP requested\n");
-    proc_.kill();
-    proc_.waitForFinished(1500);
+    if (tput_.isRunning())
+    {
+        appendOutput("\n[" + nowStamp() + "] STOP requested\n");
+        tput_.stop();
+        return;
+    }
 
-    // Clear any remaining host queue.
-    hostQueue_.clear();
+    if (engine_.isIdle())
+    {
+        setRunning(false);
+        return;
+    }
 
-    setRunning(false);
-    statusLabel_->setText("Stopped");
+    appendOutput("\n[" + nowStamp() + "] STOP requested\n");
+    stopping_ = true;
+    engine_.cancelAll();
 }
 
 void PingToolWindow::onTracerouteClicked()
 {
-    if (proc_.state() != QProcess::NotRunning)
+    if (isBusy())
         return;
 
     const QString host = hostEdit_->text().trimmed();
@@ -297,14 +568,28 @@ void PingToolWindow::onTracerouteClicked()
         return;
     }
 
-    hostQueue_.clear();
-    const Command cmd = PingCommandBuilder::buildTraceroute(host, ipv6Chk_->isChecked());
-    totalExpectedReplies_ = 0;
-    startCommand(cmd.program, cmd.args, "TRACEROUTE " + host);
+    const bool dual = (selectedFamily() == AddressFamily::DualStack);
+    engine_.setMaxConcurrent(dual ? 2 : 1);
+
+    ProbeJob job;
+    job.kind = ProbeKind::Traceroute;
+    job.host = host;
+    job.ping.family = selectedFamily();
+    if (dual)
+    {
+        job.ping.family = AddressFamily::IPv4;
+        engine_.submit(job);
+        job.ping.family = AddressFamily::IPv6;
+    }
+    engine_.submit(job);
+    beginBatch(0);
 }
 
 void PingToolWindow::onDnsClicked()
 {
+    if (isBusy())
+        return;
+
     const QString host = hostEdit_->text().trimmed();
     if (host.isEmpty())
     {
@@ -312,39 +597,281 @@ void PingToolWindow::onDnsClicked()
         return;
     }
 
-    appendOutput("\n[" + nowStamp() + "] DNS lookup: " + host + "\n");
+    ProbeJob job;
+    job.kind = ProbeKind::Dns;
+    job.host = host;
+    engine_.submit(job);
+    beginBatch(0);
+}
 
-    QHostInfo::lookupHost(host, this, [this, host](const QHostInfo& info)
+void PingToolWindow::onTcpTestClicked()
+{
+    if (isBusy())
+        return;
+
+    const QString host = hostEdit_->text().trimmed();
+    if (host.isEmpty())
+    {
+        QMessageBox::warning(this, "PingTool", "Please enter a host.");
+        return;
+    }
+
+    ProbeJob job;
+    job.kind = ProbeKind::TcpConnect;
+    job.host = host;
+    job.port = static_cast<quint16>(tcpPortSpin_->value());
+    job.family = selectedFamily();
+    job.ping = currentPingOptions();
+    job.ping.count = countSpin_->value();
+    engine_.setMaxConcurrent(1);
+    engine_.submit(job);
+    beginBatch(job.ping.count);
+}
+
+void PingToolWindow::onProbeStarted(quint64 id, const ProbeJob& job, const QString& commandLine)
+{
+    hosts_.insert(id, job.host);
+    if (job.kind == ProbeKind::Ping && bus_.isOpen())
+    {
+        PingFeed feed;
+        feed.host = job.host;
+#ifdef Q_OS_MAC
+        feed.nextSeq = 0;  // iputils numbers probes from 1, macOS from 0
+#endif
+        feeds_.insert(id, feed);
+    }
+
+    // Concurrent jobs (dual-stack) get their lines tagged with the family.
+    QString tag;
+    if (engine_.maxConcurrent() > 1)
+    {
+        tag = job.ping.family == AddressFamily::IPv6 ? "[IPv6] " : "[IPv4] ";
+        tags_.insert(id, tag);
+    }
+
+    appendOutput("\n");
+
+    switch (job.kind)
+    {
+    case ProbeKind::Ping:
+        appendOutput(tag + "[" + nowStamp() + "] PING " + job.host + "\n");
+        appendOutput(tag + "Command: " + commandLine + "\n\n");
+        break;
+    case ProbeKind::Traceroute:
+        appendOutput(tag + "[" + nowStamp() + "] TRACEROUTE " + job.host + "\n");
+        appendOutput(tag + "Command: " + commandLine + "\n\n");
+        break;
+    case ProbeKind::TcpConnect:
+        appendOutput("[" + nowStamp() + "] TCP test: " + job.host + ":" + QString::number(job.port)
+            + " (" + QString::number(qMax(1, job.ping.count)) + " attempt(s)"
+            + (job.family == AddressFamily::DualStack ? QString(", dual-stack race") : QString()) + ")\n");
+        break;
+    case ProbeKind::Dns:
+        appendOutput("[" + nowStamp() + "] DNS lookup: " + job.host + "\n");
+        break;
+    }
+
+    setRunning(true);
+    statusLabel_->setText("Running...");
+    pktLabel_->setText("Packets: -");
+    rttLabel_->setText("RTT: -");
+    updateProgress(false);
+}
+
+void PingToolWindow::onProbeOutput(quint64 id, const QString& chunk)
+{
+    if (totalExpectedReplies_ > 0)
+        repliesSoFar_ += PingOutputParser::countRepliesInChunk(chunk);
+
+    const auto feed = feeds_.find(id);
+    if (feed != feeds_.end())
+    {
+        feed->partial += chunk;
+        const int cut = feed->partial.lastIndexOf('\n');
+        if (cut >= 0)
+        {
+            const QStringList lines = feed->partial.left(cut).split('\n');
+            feed->partial.remove(0, cut + 1);
+            for (const auto& line : lines)
+                publishPingLine(*feed, line);
+        }
+    }
+
+    const auto tag = tags_.constFind(id);
+    if (tag == tags_.constEnd())
     {
-        if (info.error() != QHostInfo::NoError)
+        appendOutput(chunk);
+    }
+    else
+    {
+        // Only whole lines, so two interleaved outputs stay readable.
+        QString& pending = partial_[id];
+        pending += chunk;
+        const int cut = pending.lastIndexOf('\n');
+        if (cut >= 0)
         {
-            appendOutput("DNS error: " + info.errorString() + "\n");
+            const QStringList lines = pending.left(cut).split('\n');
+            pending.remove(0, cut + 1);
+            for (const auto& line : lines)
+                appendOutput(*tag + line + "\n");
+        }
+    }
+    updateProgress(false);
+}
+
+void PingToolWindow::publishPingLine(PingFeed& feed, const QString& line)
+{
+    PingReply reply;
+    if (!PingOutputParser::parseProbeLine(line, &reply))
+        return;
+
+    if (reply.seq >= 0)
+    {
+        // icmp_seq is 16 bits and wraps; a reply from behind was already
+        // published as a loss. A gap means lines were missing altogether.
+        const int gap = (reply.seq - feed.nextSeq) & 0xFFFF;
+        if (gap >= 0x8000)
             return;
+        for (int i = 0; i < gap; ++i)
+            bus_.publish(feed.host, false, -1.0);
+        feed.losses += gap;
+        feed.nextSeq = (reply.seq + 1) & 0xFFFF;
+    }
+
+    // Windows "time<1ms" goes out as 1 ms, the bound it gives.
+    bus_.publish(feed.host, reply.replied, reply.rttMs);
+    if (reply.replied) ++feed.replies;
+    else ++feed.losses;
+}
+
+void PingToolWindow::onTcpSample(quint64 id, const TcpConnectSample& sample)
+{
+    bus_.publish(hosts_.value(id), sample.ok, sample.userMs);
+
+    QString line;
+    if (sample.ok)
+    {
+        line = "TCP connect: OK (" + QString::number(sample.userMs, 'f', 3) + " ms)";
+        if (sample.raced)
+            line += " via " + sample.address + " | " + formatRace(sample.race);
+        if (sample.kernel.valid)
+            line += " | " + formatTcpInfo(sample.kernel);
+    }
+    else
+    {
+        line = "TCP connect: FAIL (" + QString::number(sample.userMs, 'f', 3) + " ms) - " + sample.error;
+    }
+    line += " | mono " + QString::number(sample.kernel.monoNs) + " ns";
+    appendOutput(line + "\n");
+
+    ++repliesSoFar_;
+    updateProgress(false);
+}
+
+void PingToolWindow::onHopResolved(quint64 id, const TraceHop& hop)
+{
+    Q_UNUSED(id);
+
+    if (!hop.hostName.isEmpty())
+        appendOutput(QString("Hop %1 %2: %3\n").arg(hop.hop).arg(hop.address, hop.hostName));
+}
+
+void PingToolWindow::onProbeFinished(const ProbeResult& result)
+{
+    hosts_.remove(result.id);
+    const QString tag = tags_.take(result.id);
+    const QString rest = partial_.take(result.id);
+    if (!rest.isEmpty())
+        appendOutput(tag + rest + "\n");
+
+    const auto feed = feeds_.find(result.id);
+    if (feed != feeds_.end())
+    {
+        publishPingLine(*feed, feed->partial);
+
+        // Probes that never got a reply line: trailing losses, and on
+        // Windows errors such as "Destination host unreachable".
+        if (result.stats.hasPacketStats)
+        {
+            for (int i = feed->replies + feed->losses; i < result.stats.sent; ++i)
+                bus_.publish(feed->host, false, -1.0);
         }
+        feeds_.erase(feed);
+    }
 
-        QStringList ips;
-        for (const auto& addr : info.addresses())
-            ips << addr.toString();
+    switch (result.job.kind)
+    {
+    case ProbeKind::Ping:
+        if (!result.cancelled && !result.error.isEmpty() && result.output.isEmpty())
+            appendOutput(tag + "ERROR: " + result.error + "\n");
+        if (!tag.isEmpty())
+            appendOutput(tag + "Stats " + result.job.host + ": " + formatStats(result.stats) + "\n");
+        updateStatsUI(result.stats);
+        break;
+    case ProbeKind::Traceroute:
+        if (!result.cancelled && !result.error.isEmpty() && result.output.isEmpty())
+            appendOutput(tag + "ERROR: " + result.error + "\n");
+        if (!result.hops.isEmpty())
+            appendOutput(formatHopTable(tag, result.hops));
+        break;
+    case ProbeKind::TcpConnect:
+    {
+        if (result.tcp.isEmpty())
+            break;
 
-        appendOutput("Addresses: " + ips.join(", ") + "\n");
+        double kernelSumMs = 0.0;
+        int kernelCount = 0;
+        for (const auto& t : result.tcp)
+        {
+            if (!t.ok || !t.kernel.valid) continue;
+            kernelSumMs += static_cast<double>(t.kernel.srttUs) / 1000.0;
+            ++kernelCount;
+        }
 
-        // Reverse lookup for first address
-        if (!info.addresses().isEmpty())
+        QString summary = QString("TCP summary: %1/%2 connected").arg(result.stats.received).arg(result.stats.sent);
+        if (result.stats.hasRtt)
+            summary += ", userland avg " + QString::number(result.stats.rttAvgMs, 'f', 3) + " ms";
+        if (kernelCount > 0)
+            summary += ", kernel srtt avg " + QString::number(kernelSumMs / kernelCount, 'f', 3) + " ms";
+        appendOutput(summary + "\n");
+        updateStatsUI(result.stats);
+        break;
+    }
+    case ProbeKind::Dns:
+        if (result.cancelled)
+            break;
+        if (!result.ok)
         {
-            const auto first = info.addresses().first();
-            QHostInfo::lookupHost(first.toString(), this, [this, first](const QHostInfo& rev)
-            {
-                if (rev.error() == QHostInfo::NoError)
-                    appendOutput("Reverse (" + first.toString() + "): " + rev.hostName() + "\n");
-                else
-                    appendOutput("Reverse (" + first.toString() + "): " + rev.errorString() + "\n");
-            });
+            appendOutput("DNS error: " + result.error + "\n");
+            break;
         }
-    });
+        appendOutput("Addresses: " + result.addresses.join(", ") + "\n");
+        if (!result.addresses.isEmpty())
+        {
+            const QString& first = result.addresses.first();
+            if (result.reverseError.isEmpty())
+                appendOutput("Reverse (" + first + "): " + result.reverseName + "\n");
+            else
+                appendOutput("Reverse (" + first + "): " + result.reverseError + "\n");
+        }
+        break;
+    }
+
+    updateProgress(false);
 }
 
-void PingToolWindow::onTcpTestClicked()
+void PingToolWindow::onEngineIdle()
 {
+    setRunning(false);
+    statusLabel_->setText(stopping_ ? "Stopped" : "Done");
+    stopping_ = false;
+}
+
+void PingToolWindow::onThroughputClicked()
+{
+    if (isBusy())
+        return;
+
     const QString host = hostEdit_->text().trimmed();
     if (host.isEmpty())
     {
@@ -354,27 +881,62 @@ void PingToolWindow::onTcpTestClicked()
 
     const int port = tcpPortSpin_->value();
 
-    appendOutput("\n[" + nowStamp() + "] TCP test: " + host + ":" + QString::number(port) + "\n");
+    ThroughputOptions opt;
+    opt.streams = streamsSpin_->value();
+    opt.durationSec = durationSpin_->value();
 
-    auto* sock = new QTcpSocket(this);
-    tcpTimer_.restart();
-    sock->connectToHost(host, static_cast<quint16>(port));
+    appendOutput("\n[" + nowStamp() + "] THROUGHPUT " + host + ":" + QString::number(port)
+        + " (" + QString::number(opt.streams) + " stream(s), " + QString::number(opt.durationSec) + " s)\n");
+
+    totalExpectedReplies_ = 0;
+    setRunning(true);
+    statusLabel_->setText("Throughput test...");
+    tput_.start(host, static_cast<quint16>(port), opt);
+}
 
-    connect(sock, &QTcpSocket::connected, this, [this, sock]()
+void PingToolWindow::onThroughputServerToggled(bool on)
+{
+    if (!on)
     {
-        const qint64 ms = tcpTimer_.elapsed();
-        appendOutput("TCP connect: OK (" + QString::number(ms) + " ms)\n");
-        sock->disconnectFromHost();
-    });
+        tputServer_.stop();
+        appendOutput("\n[" + nowStamp() + "] Throughput server stopped\n");
+        return;
+    }
 
-    connect(sock, &QTcpSocket::errorOccurred, this, [this, sock](QAbstractSocket::SocketError)
+    const int port = tcpPortSpin_->value();
+    if (!tputServer_.start(static_cast<quint16>(port), ThroughputOptions()))
     {
-        const qint64 ms = tcpTimer_.elapsed();
-        appendOutput("TCP connect: FAIL (" + QString::number(ms) + " ms) - " + sock->errorString() + "\n");
-        sock->deleteLater();
-    });
+        appendOutput("\n[" + nowStamp() + "] Throughput server: cannot listen on port "
+            + QString::number(port) + " - " + tputServer_.errorString() + "\n");
+        const QSignalBlocker block(tputServerChk_);
+        tputServerChk_->setChecked(false);
+        return;
+    }
 
-    connect(sock, &QTcpSocket::disconnected, sock, &QObject::deleteLater);
+    appendOutput("\n[" + nowStamp() + "] Throughput server listening on port " + QString::number(port) + "\n");
+}
+
+void PingToolWindow::onPublishToggled(bool on)
+{
+    if (!on)
+    {
+        monitor_.setResultBus(nullptr);
+        bus_.close();
+        appendOutput("\n[" + nowStamp() + "] Result bus closed\n");
+        return;
+    }
+
+    QString error;
+    if (!bus_.open(QString::fromLatin1(kResultBusDefaultName), 65536, &error))
+    {
+        appendOutput("\n[" + nowStamp() + "] Result bus: " + error + "\n");
+        const QSignalBlocker block(publishChk_);
+        publishChk_->setChecked(false);
+        return;
+    }
+
+    monitor_.setResultBus(&bus_);
+    appendOutput("\n[" + nowStamp() + "] Publishing results to shared memory " + bus_.name() + "\n");
 }
 
 void PingToolWindow::onClearClicked()
@@ -405,18 +967,6 @@ void PingToolWindow::onCopyClicked()
     QApplication::clipboard()->setText(output_->toPlainText());
 }
 
-void PingToolWindow::onProcReadyRead()
-{
-    const QString chunk = QString::fromLocal8Bit(proc_.readAll());
-    fullText_ += chunk;
-
-    if (totalExpectedReplies_ > 0)
-        repliesSoFar_ += PingOutputParser::countRepliesInChunk(chunk);
-
-    appendOutput(chunk);
-    updateProgress(false);
-}
-
 void PingToolWindow::updateProgress(bool finished)
 {
     if (totalExpectedReplies_ <= 0)
@@ -434,10 +984,8 @@ void PingToolWindow::updateProgress(bool finished)
     progress_->setFormat(QString("%1/%2").arg(done).arg(totalExpectedReplies_));
 }
 
-void PingToolWindow::updateStatsUI(const QString& fullText)
+void PingToolWindow::updateStatsUI(const PingStats& st)
 {
-    const PingStats st = PingOutputParser::parse(fullText);
-
     if (st.hasPacketStats)
     {
         pktLabel_->setText(QString("Packets: sent %1, recv %2, loss %3%")
@@ -465,30 +1013,3 @@ void PingToolWindow::updateStatsUI(const QString& fullText)
         rttLabel_->setText("RTT: -");
     }
 }
-
-void PingToolWindow::onProcFinished(int exitCode, QProcess::ExitStatus status)
-{
-    Q_UNUSED(exitCode);
-    Q_UNUSED(status);
-
-    updateStatsUI(fullText_);
-    updateProgress(true);
-
-    if (!hostQueue_.isEmpty())
-    {
-        setRunning(false);
-        startNextHostIfAny();
-        return;
-    }
-
-    setRunning(false);
-    statusLabel_->setText("Done");
-}
-
-void PingToolWindow::onProcError(QProcess::ProcessError err)
-{
-    Q_UNUSED(err);
-    setRunning(false);
-    statusLabel_->setText("Process error");
-    appendOutput("\nERROR: " + proc_.errorString() + "\n");
-}
@@ -1,7 +1,11 @@
 #pragma once
+#include <QHash>
 #include <QMainWindow>
-#include <QProcess>
-#include <QElapsedTimer>
+
+#include "AdaptiveMonitor.h"
+#include "ProbeEngine.h"
+#include "ResultBusPublisher.h"
+#include "ThroughputTest.h"
 
 QT_BEGIN_NAMESPACE
 class QLineEdit;
@@ -12,6 +16,7 @@ class QLabel;
 class QSpinBox;
 class QDoubleSpinBox;
 class QCheckBox;
+class QComboBox;
 class QGroupBox;
 class QTabWidget;
 QT_END_NAMESPACE
@@ -30,22 +35,44 @@ private slots:
     void onTracerouteClicked();
     void onDnsClicked();
     void onTcpTestClicked();
+    void onThroughputClicked();
+    void onThroughputServerToggled(bool on);
+    void onPublishToggled(bool on);
     void onClearClicked();
     void onSaveClicked();
     void onCopyClicked();
 
-    void onProcReadyRead();
-    void onProcFinished(int exitCode, QProcess::ExitStatus status);
-    void onProcError(QProcess::ProcessError err);
+    void onProbeStarted(quint64 id, const ProbeJob& job, const QString& commandLine);
+    void onProbeOutput(quint64 id, const QString& chunk);
+    void onTcpSample(quint64 id, const TcpConnectSample& sample);
+    void onHopResolved(quint64 id, const TraceHop& hop);
+    void onProbeFinished(const ProbeResult& result);
+    void onEngineIdle();
+    void onAdaptiveResult(const AdaptiveProbeReport& report);
 
 private:
+    // Ping job whose replies go to the result bus.
+    struct PingFeed
+    {
+        QString host;
+        QString partial;   // incomplete last line
+        int nextSeq = 1;   // icmp_seq expected next
+        int replies = 0;
+        int losses = 0;
+    };
+
+    bool isBusy() const;
+    AddressFamily selectedFamily() const;
+    PingOptions currentPingOptions() const;
+    void beginBatch(int expectedReplies);
+    void startAdaptiveMonitor(const QStringList& hosts);
+    void stopAdaptiveMonitor();
     void setRunning(bool running);
     void appendOutput(const QString& text);
-    void startCommand(const QString& program, const QStringList& args, const QString& headerLine);
     QStringList splitHosts(const QString& input) const;
-    void startNextHostIfAny();
-    void updateStatsUI(const QString& fullText);
+    void updateStatsUI(const PingStats& st);
     void updateProgress(bool finished = false);
+    void publishPingLine(PingFeed& feed, const QString& line);
 
     // UI
     QLineEdit* hostEdit_ = nullptr;
@@ -54,6 +81,8 @@ private:
     QPushButton* traceBtn_ = nullptr;
     QPushButton* dnsBtn_ = nullptr;
     QPushButton* tcpBtn_ = nullptr;
+    QPushButton* tputBtn_ = nullptr;
+    QCheckBox* tputServerChk_ = nullptr;
     QPushButton* clearBtn_ = nullptr;
     QPushButton* saveBtn_ = nullptr;
     QPushButton* copyBtn_ = nullptr;
@@ -62,10 +91,14 @@ private:
     QSpinBox* timeoutSpin_ = nullptr;
     QDoubleSpinBox* intervalSpin_ = nullptr;
     QSpinBox* payloadSpin_ = nullptr;
-    QCheckBox* ipv6Chk_ = nullptr;
+    QComboBox* familyCombo_ = nullptr;
     QCheckBox* continuousChk_ = nullptr;
+    QCheckBox* adaptiveChk_ = nullptr;
+    QCheckBox* publishChk_ = nullptr;
 
     QSpinBox* tcpPortSpin_ = nullptr;
+    QSpinBox* streamsSpin_ = nullptr;
+    QSpinBox* durationSpin_ = nullptr;
 
     QTextEdit* output_ = nullptr;
     QProgressBar* progress_ = nullptr;
@@ -73,15 +106,23 @@ private:
     QLabel* pktLabel_ = nullptr;
     QLabel* rttLabel_ = nullptr;
 
-    // Process execution
-    QProcess proc_;
-    QString currentProgram_;
-    QStringList currentArgs_;
-    QString fullText_;
-    QStringList hostQueue_;
+    // Probes (ping, traceroute, DNS, TCP test)
+    ProbeEngine engine_;
+    bool stopping_ = false;
     int totalExpectedReplies_ = 0;
     int repliesSoFar_ = 0;
+    QHash<quint64, QString> tags_;     // dual-stack: per-job line prefix
+    QHash<quint64, QString> partial_;  // dual-stack: incomplete last line
+    QHash<quint64, QString> hosts_;    // per-job host, for the result bus
+    QHash<quint64, PingFeed> feeds_;   // ping jobs, while the bus is open
+
+    // Shared-memory result bus (ping and TCP Test results)
+    ResultBusPublisher bus_;
+
+    // Continuous ping with adaptive per-target rate
+    AdaptiveMonitor monitor_;
 
-    // TCP test
-    QElapsedTimer tcpTimer_;
+    // Throughput test
+    ThroughputClient tput_;
+    ThroughputServer tputServer_;
 };
@@ -0,0 +1,230 @@
+#include "ProbeAgent.h"
+
+#include <QDateTime>
+#include <QRandomGenerator>
+
+#include <algorithm>
+
+static constexpr int kReconnectMinMs = 500;
+static constexpr int kReconnectMaxMs = 30000;
+
+ProbeAgent::ProbeAgent(QObject* parent)
+    : QObject(parent)
+{
+    reconnect_.setSingleShot(true);
+    connect(&reconnect_, &QTimer::timeout, this, &ProbeAgent::connectToCollector);
+    connect(&flush_, &QTimer::timeout, this, &ProbeAgent::onFlushTimer);
+
+    connect(&monitor_, &AdaptiveMonitor::probeResult, this, &ProbeAgent::onProbeResult);
+
+    connect(&sock_, &QTcpSocket::connected, this, &ProbeAgent::onConnected);
+    connect(&sock_, &QTcpSocket::disconnected, this, &ProbeAgent::onDisconnected);
+    connect(&sock_, &QTcpSocket::readyRead, this, &ProbeAgent::onReadyRead);
+    connect(&sock_, &QTcpSocket::bytesWritten, this, [this]() { pump(false); });
+    connect(&sock_, &QTcpSocket::errorOccurred, this, [this](QAbstractSocket::SocketError)
+    {
+        // A failed connect never emits disconnected().
+        if (sock_.state() == QAbstractSocket::UnconnectedState)
+            onDisconnected();
+    });
+}
+
+void ProbeAgent::start(const ProbeAgentOptions& opt, const QStringList& targets)
+{
+    stop();
+
+    opt_ = opt;
+    opt_.batchRecords = qMax(1, opt.batchRecords);
+    opt_.windowRecords = qMax(opt_.batchRecords, opt.windowRecords);
+    targets_ = targets;
+
+    pending_.clear();
+    epoch_ = QRandomGenerator::global()->generate64();
+    firstSeq_ = nextSeq_ = 1;
+    sentSeq_ = ackedSeq_ = 0;
+    dropped_ = 0;
+    reconnectDelayMs_ = 0;
+
+    running_ = true;
+    connectToCollector();
+    flush_.start(qMax(10, opt_.flushIntervalMs));
+    monitor_.start(targets_);
+}
+
+void ProbeAgent::stop()
+{
+    if (!running_) return;
+
+    running_ = false;
+    monitor_.stop();
+    flush_.stop();
+    reconnect_.stop();
+
+    // Hand over whatever the window allows; disconnectFromHost() still
+    // writes out queued bytes.
+    pump(true);
+    ready_ = false;
+    sock_.disconnectFromHost();
+}
+
+void ProbeAgent::connectToCollector()
+{
+    ready_ = false;
+    rx_.clear();
+    sock_.abort();
+    sock_.connectToHost(opt_.collectorHost, opt_.collectorPort);
+}
+
+void ProbeAgent::scheduleReconnect()
+{
+    if (!running_ || reconnect_.isActive()) return;
+
+    reconnectDelayMs_ = reconnectDelayMs_ == 0
+        ? kReconnectMinMs
+        : qMin(kReconnectMaxMs, reconnectDelayMs_ * 2);
+    emit message(QString("Collector %1:%2 unavailable (%3), retrying in %4 s")
+        .arg(opt_.collectorHost).arg(opt_.collectorPort).arg(sock_.errorString())
+        .arg(reconnectDelayMs_ / 1000.0, 0, 'f', 1));
+    reconnect_.start(reconnectDelayMs_);
+}
+
+void ProbeAgent::onConnected()
+{
+    sock_.setSocketOption(QAbstractSocket::LowDelayOption, 1);
+
+    ResultHello hello;
+    hello.agentId = opt_.agentId;
+    hello.epoch = epoch_;
+    sock_.write(ResultProtocol::encodeHello(hello));
+
+    QVector<ResultTarget> defs;
+    defs.reserve(targets_.size());
+    for (int i = 0; i < targets_.size(); ++i)
+        defs.push_back({ quint32(i), targets_[i] });
+    sock_.write(ResultProtocol::encodeTargets(defs));
+}
+
+void ProbeAgent::onDisconnected()
+{
+    ready_ = false;
+    scheduleReconnect();
+}
+
+void ProbeAgent::onReadyRead()
+{
+    rx_ += sock_.readAll();
+
+    for (;;)
+    {
+        ResultFrameType type;
+        QByteArray payload;
+        const auto take = ResultProtocol::takeFrame(rx_, &type, &payload);
+        if (take == ResultProtocol::Take::NeedMore)
+            return;
+
+        quint64 seq = 0;
+        if (take == ResultProtocol::Take::Invalid || !ResultProtocol::decodeSeq(payload, &seq))
+        {
+            emit message("Collector sent a malformed frame; reconnecting");
+            sock_.abort();
+            return;
+        }
+
+        if (type == ResultFrameType::HelloAck)
+        {
+            // Everything up to seq is stored; resend the rest. Records dropped
+            // while disconnected show up as a gap on the collector.
+            trimAcked(seq);
+            sentSeq_ = std::max(ackedSeq_, firstSeq_ - 1);
+            ready_ = true;
+            reconnectDelayMs_ = 0;
+            emit message(QString("Connected to collector %1:%2, resuming after seq %3 (%4 buffered)")
+                .arg(opt_.collectorHost).arg(opt_.collectorPort).arg(sentSeq_).arg(pending_.size()));
+        }
+        else if (type == ResultFrameType::Ack)
+        {
+            trimAcked(seq);
+        }
+        pump(false);
+    }
+}
+
+void ProbeAgent::trimAcked(quint64 seq)
+{
+    seq = std::min(seq, lastSeq());
+    ackedSeq_ = std::max(ackedSeq_, seq);
+    while (!pending_.empty() && firstSeq_ <= ackedSeq_)
+    {
+        pending_.pop_front();
+        ++firstSeq_;
+    }
+}
+
+void ProbeAgent::pump(bool flushPartial)
+{
+    if (!ready_) return;
+
+    for (;;)
+    {
+        // Records dropped from the buffer count as settled: they will never
+        // be sent, so no Ack can cover them.
+        const quint64 settled = std::max(ackedSeq_, firstSeq_ - 1);
+        const quint64 from = std::max(sentSeq_ + 1, firstSeq_);
+        const quint64 unsent = nextSeq_ - from;
+        const quint64 inFlight = sentSeq_ > settled ? sentSeq_ - settled : 0;
+        if (unsent == 0 || inFlight >= quint64(opt_.windowRecords))
+            return;
+
+        // Backpressure: let the kernel drain before queueing more.
+        if (sock_.bytesToWrite() > opt_.maxSocketBacklogBytes)
+            return;
+
+        const int n = static_cast<int>(std::min<quint64>({ quint64(opt_.batchRecords), unsent,
+                                                           quint64(opt_.windowRecords) - inFlight }));
+        if (n < opt_.batchRecords && !flushPartial)
+            return;
+
+        const auto begin = pending_.cbegin() + static_cast<std::ptrdiff_t>(from - firstSeq_);
+        const QVector<ResultRecord> batch(begin, begin + n);
+        sock_.write(ResultProtocol::encodeBatch(from, batch));
+        sentSeq_ = from + n - 1;
+    }
+}
+
+void ProbeAgent::onFlushTimer()
+{
+    pump(true);
+}
+
+void ProbeAgent::onProbeResult(const AdaptiveProbeReport& report)
+{
+    ResultRecord rec;
+    rec.targetId = quint32(report.targetId);
+    rec.timestampMs = QDateTime::currentMSecsSinceEpoch();
+    if (report.replied)
+    {
+        rec.status = ResultStatus::Reply;
+        rec.rttUs = report.rttMs >= 0 ? quint32(qRound64(report.rttMs * 1000.0)) : 0;
+    }
+    else
+    {
+        rec.status = ResultStatus::Loss;
+    }
+    queue(rec);
+}
+
+void ProbeAgent::queue(const ResultRecord& rec)
+{
+    pending_.push_back(rec);
+    ++nextSeq_;
+
+    // Bounded buffer: while the collector is away, keep the newest results.
+    while (pending_.size() > size_t(qMax(1, opt_.maxBufferedRecords)))
+    {
+        pending_.pop_front();
+        ++firstSeq_;
+        ++dropped_;
+    }
+
+    pump(false);
+}
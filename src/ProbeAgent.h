@@ -0,0 +1,86 @@
+#pragma once
+#include <QByteArray>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QTcpSocket>
+#include <QTimer>
+
+#include <deque>
+
+#include "AdaptiveMonitor.h"
+#include "ResultProtocol.h"
+
+struct ProbeAgentOptions
+{
+    QString agentId;
+    QString collectorHost = "127.0.0.1";
+    quint16 collectorPort = 9300;
+    int batchRecords = 256;                // records per Batch frame
+    int flushIntervalMs = 200;             // longest a record waits for a full batch
+    int windowRecords = 8192;              // sent but not yet acknowledged
+    int maxBufferedRecords = 200000;       // oldest are dropped beyond this
+    qint64 maxSocketBacklogBytes = 256 * 1024;
+};
+
+// Runs an AdaptiveMonitor over a target list and streams every result to a
+// ProbeCollector. Results are buffered until acknowledged, so a dropped
+// connection resumes from the collector's last stored sequence number.
+class ProbeAgent final : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ProbeAgent(QObject* parent = nullptr);
+
+    AdaptiveMonitor& monitor() { return monitor_; }
+
+    void start(const ProbeAgentOptions& opt, const QStringList& targets);
+    void stop();
+
+    // Queues one result for the collector; the monitor's results land here.
+    // targetId indexes the list given to start().
+    void queue(const ResultRecord& rec);
+
+    bool isConnected() const { return ready_; }
+    quint64 lastSeq() const { return nextSeq_ - 1; }
+    quint64 ackedSeq() const { return ackedSeq_; }
+    qint64 buffered() const { return static_cast<qint64>(pending_.size()); }
+    qint64 dropped() const { return dropped_; }
+
+signals:
+    void message(const QString& text);
+
+private slots:
+    void onProbeResult(const AdaptiveProbeReport& report);
+    void onConnected();
+    void onDisconnected();
+    void onReadyRead();
+    void onFlushTimer();
+
+private:
+    void connectToCollector();
+    void scheduleReconnect();
+    void trimAcked(quint64 seq);
+    void pump(bool flushPartial);
+
+    ProbeAgentOptions opt_;
+    AdaptiveMonitor monitor_;
+    QStringList targets_;
+    QTcpSocket sock_;
+    QByteArray rx_;
+    QTimer flush_;
+    QTimer reconnect_;
+    int reconnectDelayMs_ = 0;
+    bool running_ = false;
+    bool ready_ = false;  // HelloAck received on the current connection
+
+    // pending_[i] has sequence number firstSeq_ + i.
+    std::deque<ResultRecord> pending_;
+    quint64 epoch_ = 0;
+    quint64 firstSeq_ = 1;
+    quint64 nextSeq_ = 1;
+    quint64 sentSeq_ = 0;  // highest seq written on the current connection
+    quint64 ackedSeq_ = 0;
+    qint64 dropped_ = 0;
+};
@@ -0,0 +1,258 @@
+#include "ProbeCollector.h"
+
+#include <QStringList>
+#include <QTcpSocket>
+
+#include <algorithm>
+
+ProbeCollector::ProbeCollector(QObject* parent)
+    : QTcpServer(parent)
+{
+}
+
+ProbeCollector::~ProbeCollector()
+{
+    stop();
+}
+
+bool ProbeCollector::start(quint16 port, const QHostAddress& address)
+{
+    return listen(address, port);
+}
+
+void ProbeCollector::stop()
+{
+    close();
+
+    const auto socks = sessions_.keys();
+    sessions_.clear();
+    for (QTcpSocket* sock : socks)
+    {
+        sock->disconnect(this);
+        sock->abort();
+        sock->deleteLater();
+    }
+    for (auto& a : agents_)
+        a.connected = false;
+}
+
+void ProbeCollector::incomingConnection(qintptr socketDescriptor)
+{
+    auto* sock = new QTcpSocket(this);
+    if (!sock->setSocketDescriptor(socketDescriptor))
+    {
+        delete sock;
+        return;
+    }
+
+    sessions_.insert(sock, Session());
+    connect(sock, &QTcpSocket::readyRead, this, [this, sock]() { onReadyRead(sock); });
+    connect(sock, &QTcpSocket::disconnected, this, [this, sock]() { dropSession(sock); });
+}
+
+void ProbeCollector::onReadyRead(QTcpSocket* sock)
+{
+    auto it = sessions_.find(sock);
+    if (it == sessions_.end()) return;
+
+    it->rx += sock->readAll();
+    for (;;)
+    {
+        ResultFrameType type;
+        QByteArray payload;
+        const auto take = ResultProtocol::takeFrame(it->rx, &type, &payload);
+        if (take == ResultProtocol::Take::NeedMore)
+            return;
+
+        if (take == ResultProtocol::Take::Invalid || !handleFrame(sock, *it, type, payload))
+        {
+            emit message(QString("Collector: protocol error from %1, closing")
+                .arg(sock->peerAddress().toString()));
+            sock->abort();
+            dropSession(sock);  // no-op if abort() already emitted disconnected()
+            return;
+        }
+    }
+}
+
+bool ProbeCollector::handleFrame(QTcpSocket* sock, Session& s, ResultFrameType type, const QByteArray& payload)
+{
+    if (type == ResultFrameType::Hello)
+    {
+        ResultHello hello;
+        if (!s.agentId.isEmpty() || !ResultProtocol::decodeHello(payload, &hello))
+            return false;
+
+        // A reconnect can arrive before the old connection is noticed dead.
+        for (auto it = sessions_.begin(); it != sessions_.end(); ++it)
+        {
+            if (it.key() == sock || it->agentId != hello.agentId) continue;
+            it->agentId.clear();
+            QTcpSocket* old = it.key();
+            QMetaObject::invokeMethod(old, [old]() { old->abort(); }, Qt::QueuedConnection);
+        }
+
+        CollectorAgentState& a = agents_[hello.agentId];
+        if (a.agentId.isEmpty() || a.epoch != hello.epoch)
+        {
+            if (!a.agentId.isEmpty())
+                emit message(QString("Collector: agent %1 restarted, sequence reset").arg(hello.agentId));
+            a.epoch = hello.epoch;
+            a.lastSeq = 0;
+        }
+        a.agentId = hello.agentId;
+        a.connected = true;
+        ++a.connections;
+        a.peer = QString("%1:%2").arg(sock->peerAddress().toString()).arg(sock->peerPort());
+
+        s.agentId = hello.agentId;
+        sock->write(ResultProtocol::encodeHelloAck(a.lastSeq));
+        emit message(QString("Collector: agent %1 connected from %2, resuming after seq %3")
+            .arg(a.agentId, a.peer).arg(a.lastSeq));
+        return true;
+    }
+
+    if (s.agentId.isEmpty())
+        return false;
+
+    if (type == ResultFrameType::Targets)
+    {
+        QVector<ResultTarget> defs;
+        if (!ResultProtocol::decodeTargets(payload, &defs))
+            return false;
+        for (const auto& d : defs)
+        {
+            if (d.id >= 1u << 24) return false;
+            if (d.id >= quint32(s.names.size())) s.names.resize(d.id + 1);
+            s.names[d.id] = d.name;
+        }
+        return true;
+    }
+
+    if (type == ResultFrameType::Batch)
+    {
+        quint64 firstSeq = 0;
+        QVector<ResultRecord> records;
+        if (!ResultProtocol::decodeBatch(payload, &firstSeq, &records) || firstSeq == 0)
+            return false;
+
+        CollectorAgentState& a = agents_[s.agentId];
+        storeBatch(s, a, firstSeq, records);
+        sock->write(ResultProtocol::encodeAck(a.lastSeq));
+        return true;
+    }
+
+    return false;
+}
+
+void ProbeCollector::storeBatch(Session& s, CollectorAgentState& agent, quint64 firstSeq,
+                                const QVector<ResultRecord>& records)
+{
+    for (int i = 0; i < records.size(); ++i)
+    {
+        // Resent after a reconnect: already stored.
+        const quint64 seq = firstSeq + quint64(i);
+        if (seq <= agent.lastSeq) continue;
+
+        agent.missing += seq - agent.lastSeq - 1;
+        agent.lastSeq = seq;
+        ++agent.records;
+        ++totalRecords_;
+
+        const ResultRecord& r = records[i];
+        const QString name = r.targetId < quint32(s.names.size()) && !s.names[r.targetId].isEmpty()
+            ? s.names[r.targetId]
+            : QString("#%1").arg(r.targetId);
+
+        CollectorTargetStats& t = targets_[name];
+        CollectorVantage& v = t.byAgent[agent.agentId];
+        ++t.sent;
+        ++v.sent;
+        t.lastMs = std::max(t.lastMs, r.timestampMs);
+        v.lastMs = r.timestampMs;
+
+        if (r.status == ResultStatus::Reply)
+        {
+            const double rtt = r.rttUs / 1000.0;
+            ++t.received;
+            ++v.received;
+            t.rttSumMs += rtt;
+            t.rttMinMs = t.rttMinMs < 0 ? rtt : std::min(t.rttMinMs, rtt);
+            t.rttMaxMs = std::max(t.rttMaxMs, rtt);
+            v.lastRttMs = rtt;
+        }
+    }
+}
+
+void ProbeCollector::dropSession(QTcpSocket* sock)
+{
+    const auto it = sessions_.constFind(sock);
+    if (it == sessions_.constEnd()) return;
+
+    const QString id = it->agentId;
+    sessions_.erase(it);
+    sock->deleteLater();
+
+    if (id.isEmpty()) return;
+    CollectorAgentState& a = agents_[id];
+    a.connected = false;
+    emit message(QString("Collector: agent %1 disconnected after seq %2").arg(id).arg(a.lastSeq));
+}
+
+QString ProbeCollector::summary(int maxTargets) const
+{
+    QStringList lines;
+
+    QStringList ids = agents_.keys();
+    ids.sort();
+    lines << QString("Agents: %1, records: %2, targets: %3")
+        .arg(ids.size()).arg(totalRecords_).arg(targets_.size());
+    for (const auto& id : ids)
+    {
+        const CollectorAgentState a = agents_.value(id);
+        lines << QString("  %1  %2  seq %3  missing %4  connects %5")
+            .arg(id, -12).arg(a.connected ? a.peer : QString("disconnected"), -22)
+            .arg(a.lastSeq).arg(a.missing).arg(a.connections);
+    }
+
+    // Worst first: highest loss, then highest average RTT.
+    using TargetIt = QHash<QString, CollectorTargetStats>::const_iterator;
+    QVector<TargetIt> order;
+    order.reserve(targets_.size());
+    for (auto it = targets_.constBegin(); it != targets_.constEnd(); ++it)
+        order << it;
+    const int shown = qBound(0, maxTargets, static_cast<int>(order.size()));
+    std::partial_sort(order.begin(), order.begin() + shown, order.end(),
+        [](const TargetIt& a, const TargetIt& b)
+        {
+            if (a->lossPct() != b->lossPct()) return a->lossPct() > b->lossPct();
+            return a->rttAvgMs() > b->rttAvgMs();
+        });
+
+    for (int i = 0; i < shown; ++i)
+    {
+        const QString& name = order[i].key();
+        const CollectorTargetStats& t = order[i].value();
+
+        QString line = QString("  %1 sent %2 recv %3 loss %4%")
+            .arg(name, -24).arg(t.sent).arg(t.received).arg(t.lossPct(), 0, 'f', 1);
+        if (t.received)
+        {
+            line += QString(" rtt %1/%2/%3 ms")
+                .arg(t.rttMinMs, 0, 'f', 2).arg(t.rttAvgMs(), 0, 'f', 2).arg(t.rttMaxMs, 0, 'f', 2);
+        }
+
+        QStringList vantage;
+        for (auto v = t.byAgent.constBegin(); v != t.byAgent.constEnd(); ++v)
+        {
+            const double loss = v->sent ? 100.0 * double(v->sent - v->received) / double(v->sent) : 0.0;
+            vantage << QString("%1 %2%").arg(v.key()).arg(loss, 0, 'f', 0)
+                + (v->lastRttMs >= 0 ? QString(" %1 ms").arg(v->lastRttMs, 0, 'f', 1) : QString());
+        }
+        vantage.sort();
+        line += " | " + vantage.join(", ");
+        lines << line;
+    }
+
+    return lines.join('\n');
+}
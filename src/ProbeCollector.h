@@ -0,0 +1,94 @@
+#pragma once
+#include <QByteArray>
+#include <QHash>
+#include <QHostAddress>
+#include <QObject>
+#include <QString>
+#include <QTcpServer>
+#include <QVector>
+
+#include "ResultProtocol.h"
+
+class QTcpSocket;
+
+struct CollectorAgentState
+{
+    QString agentId;
+    quint64 epoch = 0;
+    quint64 lastSeq = 0;   // highest sequence number stored
+    quint64 records = 0;
+    quint64 missing = 0;   // sequence gaps (dropped on the agent while disconnected)
+    int connections = 0;   // connects so far
+    bool connected = false;
+    QString peer;
+};
+
+struct CollectorVantage
+{
+    quint64 sent = 0;
+    quint64 received = 0;
+    double lastRttMs = -1.0;
+    qint64 lastMs = 0;
+};
+
+// Stats for one target name, merged across every agent probing it.
+struct CollectorTargetStats
+{
+    quint64 sent = 0;
+    quint64 received = 0;
+    double rttSumMs = 0.0;
+    double rttMinMs = -1.0;
+    double rttMaxMs = 0.0;
+    qint64 lastMs = 0;
+    QHash<QString, CollectorVantage> byAgent;
+
+    double lossPct() const { return sent ? 100.0 * double(sent - received) / double(sent) : 0.0; }
+    double rttAvgMs() const { return received ? rttSumMs / double(received) : -1.0; }
+};
+
+// Accepts ProbeAgent connections and aggregates their result streams per
+// target. Agent state (last stored sequence number) survives disconnects, so
+// a reconnecting agent resumes exactly where it stopped.
+class ProbeCollector final : public QTcpServer
+{
+    Q_OBJECT
+
+public:
+    explicit ProbeCollector(QObject* parent = nullptr);
+    ~ProbeCollector() override;
+
+    bool start(quint16 port, const QHostAddress& address = QHostAddress::Any);
+    void stop();
+
+    const QHash<QString, CollectorAgentState>& agents() const { return agents_; }
+    const QHash<QString, CollectorTargetStats>& targets() const { return targets_; }
+    quint64 totalRecords() const { return totalRecords_; }
+
+    // Agents plus the worst targets by loss, then by average RTT.
+    QString summary(int maxTargets = 20) const;
+
+signals:
+    void message(const QString& text);
+
+protected:
+    void incomingConnection(qintptr socketDescriptor) override;
+
+private:
+    struct Session
+    {
+        QByteArray rx;
+        QString agentId;  // empty until Hello
+        QVector<QString> names;  // agent target id -> name
+    };
+
+    void onReadyRead(QTcpSocket* sock);
+    bool handleFrame(QTcpSocket* sock, Session& s, ResultFrameType type, const QByteArray& payload);
+    void storeBatch(Session& s, CollectorAgentState& agent, quint64 firstSeq,
+                    const QVector<ResultRecord>& records);
+    void dropSession(QTcpSocket* sock);
+
+    QHash<QTcpSocket*, Session> sessions_;
+    QHash<QString, CollectorAgentState> agents_;
+    QHash<QString, CollectorTargetStats> targets_;
+    quint64 totalRecords_ = 0;
+};
@@ -0,0 +1,510 @@
+#include "ProbeEngine.h"
+
+#include <QHostInfo>
+#include <QMetaObject>
+#include <QProcess>
+#include <QTcpSocket>
+#include <QTimer>
+
+#include <vector>
+
+struct ProbeEngine::Running
+{
+    ProbeResult result;
+    ProbeCallback callback;
+    QObject* ctx = nullptr;       // owns the job's process/sockets; context for its connections
+    QProcess* proc = nullptr;
+    QTcpSocket* sock = nullptr;   // TcpConnect: current attempt
+    DualStackConnector* race = nullptr;
+    TcpInfoSample raceKernel;
+    int remaining = 0;
+    qint64 attemptStartNs = 0;
+    TracerouteParser trace;
+};
+
+static PingStats tcpStats(const QVector<TcpConnectSample>& samples)
+{
+    PingStats s;
+    if (samples.isEmpty()) return s;
+
+    s.hasPacketStats = true;
+    s.sent = samples.size();
+    s.received = 0;
+    double sum = 0.0;
+    for (const auto& t : samples)
+    {
+        if (!t.ok) continue;
+        if (s.received == 0 || t.userMs < s.rttMinMs) s.rttMinMs = t.userMs;
+        if (s.received == 0 || t.userMs > s.rttMaxMs) s.rttMaxMs = t.userMs;
+        sum += t.userMs;
+        ++s.received;
+    }
+    s.lost = s.sent - s.received;
+    s.lossPct = 100.0 * s.lost / s.sent;
+    if (s.received > 0)
+    {
+        s.hasRtt = true;
+        s.rttAvgMs = sum / s.received;
+    }
+    return s;
+}
+
+ProbeEngine::ProbeEngine(QObject* parent)
+    : QObject(parent)
+{
+    connect(&reverseDns_, &ReverseDnsCache::resolved, this, &ProbeEngine::onReverseResolved);
+}
+
+// Jobs still running are dropped without callbacks; their processes are
+// killed when the per-job context objects (children of this) are deleted.
+ProbeEngine::~ProbeEngine() = default;
+
+void ProbeEngine::setMaxConcurrent(int n)
+{
+    maxConcurrent_ = qMax(1, n);
+    QMetaObject::invokeMethod(this, &ProbeEngine::startQueued, Qt::QueuedConnection);
+}
+
+quint64 ProbeEngine::submit(const ProbeJob& job, ProbeCallback onFinished)
+{
+    Pending p;
+    p.id = ++nextId_;
+    p.job = job;
+    p.callback = std::move(onFinished);
+    queue_.append(std::move(p));
+
+    QMetaObject::invokeMethod(this, &ProbeEngine::startQueued, Qt::QueuedConnection);
+    return nextId_;
+}
+
+bool ProbeEngine::cancel(quint64 id)
+{
+    for (int i = 0; i < queue_.size(); ++i)
+    {
+        if (queue_[i].id != id) continue;
+
+        const Pending p = queue_.takeAt(i);
+        ProbeResult res;
+        res.id = p.id;
+        res.job = p.job;
+        res.cancelled = true;
+        res.error = "cancelled";
+        emit finished(res);
+        if (p.callback) p.callback(res);
+        if (isIdle()) emit idle();
+        return true;
+    }
+
+    Running* r = runningJob(id);
+    if (!r) return false;
+    r->result.cancelled = true;
+    r->result.error = "cancelled";
+    complete(id);
+    return true;
+}
+
+void ProbeEngine::cancelAll()
+{
+    // Queued jobs first, so completing a running one does not start them.
+    while (!queue_.isEmpty())
+        cancel(queue_.first().id);
+
+    std::vector<quint64> ids;
+    for (const auto& kv : running_)
+        ids.push_back(kv.first);
+    for (quint64 id : ids)
+        cancel(id);
+}
+
+ProbeEngine::Running* ProbeEngine::runningJob(quint64 id) const
+{
+    const auto it = running_.find(id);
+    return it == running_.end() ? nullptr : it->second.get();
+}
+
+void ProbeEngine::startQueued()
+{
+    while (!queue_.isEmpty() && static_cast<int>(running_.size()) < maxConcurrent_)
+    {
+        Pending p = queue_.takeFirst();
+
+        auto r = std::make_unique<Running>();
+        r->result.id = p.id;
+        r->result.job = p.job;
+        r->callback = std::move(p.callback);
+        r->ctx = new QObject(this);
+        running_[p.id] = std::move(r);
+
+        switch (p.job.kind)
+        {
+        case ProbeKind::Ping:
+            startProcess(p.id, PingCommandBuilder::buildPing(p.job.host, p.job.ping));
+            break;
+        case ProbeKind::Traceroute:
+            startProcess(p.id, PingCommandBuilder::buildTraceroute(p.job.host, p.job.ping.family));
+            break;
+        case ProbeKind::TcpConnect:
+            startTcp(p.id);
+            break;
+        case ProbeKind::Dns:
+            startDns(p.id);
+            break;
+        }
+    }
+}
+
+void ProbeEngine::startProcess(quint64 id, const Command& cmd)
+{
+    emit started(id, runningJob(id)->result.job, cmd.program + " " + cmd.args.join(' '));
+    Running* r = runningJob(id);
+    if (!r) return; // cancelled from a started() handler
+
+    auto* proc = new QProcess(r->ctx);
+    r->proc = proc;
+    proc->setProcessChannelMode(QProcess::MergedChannels);
+
+    connect(proc, &QProcess::readyRead, r->ctx, [this, id]()
+    {
+        Running* r = runningJob(id);
+        if (!r) return;
+        const QString chunk = QString::fromLocal8Bit(r->proc->readAll());
+        r->result.output += chunk;
+        emit output(id, chunk);
+
+        if ((r = runningJob(id)) && r->result.job.kind == ProbeKind::Traceroute)
+            addHops(id, r->trace.feed(chunk));
+    });
+
+    connect(proc, &QProcess::finished, r->ctx, [this, id](int, QProcess::ExitStatus status)
+    {
+        Running* r = runningJob(id);
+        if (!r) return;
+        const QString rest = QString::fromLocal8Bit(r->proc->readAll());
+        if (!rest.isEmpty())
+        {
+            r->result.output += rest;
+            emit output(id, rest);
+            r = runningJob(id);
+            if (!r) return;
+        }
+        if (r->result.job.kind == ProbeKind::Traceroute)
+        {
+            addHops(id, r->trace.feed(rest));
+            addHops(id, r->trace.finish());
+            r = runningJob(id);
+            if (!r) return;
+        }
+        r->result.ok = (status == QProcess::NormalExit);
+        complete(id);
+    });
+
+    connect(proc, &QProcess::errorOccurred, r->ctx, [this, id](QProcess::ProcessError err)
+    {
+        Running* r = runningJob(id);
+        if (!r) return;
+        r->result.error = r->proc->errorString();
+        // Other errors are followed by finished().
+        if (err == QProcess::FailedToStart)
+            complete(id);
+    });
+
+    // Always start the program directly (no shell) to avoid injection issues.
+    proc->start(cmd.program, cmd.args);
+}
+
+void ProbeEngine::startTcp(quint64 id)
+{
+    emit started(id, runningJob(id)->result.job, QString());
+    Running* r = runningJob(id);
+    if (!r) return;
+
+    r->remaining = qMax(1, r->result.job.ping.count);
+    startTcpAttempt(id);
+}
+
+void ProbeEngine::startTcpAttempt(quint64 id)
+{
+    Running* r = runningJob(id);
+    if (!r) return;
+
+    --r->remaining;
+    if (r->result.job.family == AddressFamily::DualStack)
+    {
+        startTcpRace(id);
+        return;
+    }
+
+    auto* sock = new QTcpSocket(r->ctx);
+    r->sock = sock;
+    r->attemptStartNs = TcpInfo::monotonicNs();
+
+    connect(sock, &QTcpSocket::connected, r->ctx, [this, id, sock]()
+    {
+        Running* r = runningJob(id);
+        if (!r || r->sock != sock) return;
+
+        // Userland time includes event-loop latency; TCP_INFO is the kernel's own view.
+        TcpConnectSample s;
+        s.ok = true;
+        s.kernel = TcpInfo::read(sock->socketDescriptor());
+        s.address = sock->peerAddress().toString();
+        s.userMs = static_cast<double>(s.kernel.monoNs - r->attemptStartNs) / 1e6;
+        finishTcpAttempt(id, s);
+    });
+
+    connect(sock, &QTcpSocket::errorOccurred, r->ctx, [this, id, sock](QAbstractSocket::SocketError)
+    {
+        Running* r = runningJob(id);
+        if (!r || r->sock != sock) return;
+
+        TcpConnectSample s;
+        s.error = sock->errorString();
+        s.kernel.monoNs = TcpInfo::monotonicNs();
+        s.userMs = static_cast<double>(s.kernel.monoNs - r->attemptStartNs) / 1e6;
+        finishTcpAttempt(id, s);
+    });
+
+    QTimer::singleShot(qMax(1, r->result.job.ping.timeoutMs), sock, [this, id, sock]()
+    {
+        Running* r = runningJob(id);
+        if (!r || r->sock != sock) return;
+
+        TcpConnectSample s;
+        s.error = "timed out";
+        s.kernel.monoNs = TcpInfo::monotonicNs();
+        s.userMs = static_cast<double>(s.kernel.monoNs - r->attemptStartNs) / 1e6;
+        finishTcpAttempt(id, s);
+    });
+
+    QAbstractSocket::NetworkLayerProtocol protocol = QAbstractSocket::AnyIPProtocol;
+    if (r->result.job.family == AddressFamily::IPv4) protocol = QAbstractSocket::IPv4Protocol;
+    else if (r->result.job.family == AddressFamily::IPv6) protocol = QAbstractSocket::IPv6Protocol;
+    sock->connectToHost(r->result.job.host, r->result.job.port, QIODevice::ReadWrite, protocol);
+}
+
+void ProbeEngine::startTcpRace(quint64 id)
+{
+    Running* r = runningJob(id);
+    if (!r) return;
+
+    auto* race = new DualStackConnector(r->ctx);
+    r->race = race;
+    r->raceKernel = TcpInfoSample();
+    r->attemptStartNs = TcpInfo::monotonicNs();
+    race->setTimeoutMs(qMax(1, r->result.job.ping.timeoutMs));
+
+    connect(race, &DualStackConnector::winnerConnected, r->ctx, [this, id, race](QTcpSocket* sock, const RaceAttempt&)
+    {
+        Running* r = runningJob(id);
+        if (!r || r->race != race) return;
+        r->raceKernel = TcpInfo::read(sock->socketDescriptor());
+    });
+
+    // Reported once the losing family has answered too.
+    connect(race, &DualStackConnector::finished, r->ctx, [this, id, race](const RaceResult& rr)
+    {
+        Running* r = runningJob(id);
+        if (!r || r->race != race) return;
+        r->race = nullptr;
+        race->deleteLater();
+
+        TcpConnectSample s;
+        s.raced = true;
+        s.race = rr;
+        s.ok = rr.ok;
+        s.error = rr.error;
+        if (rr.winner >= 0)
+        {
+            const RaceAttempt& w = rr.attempts[rr.winner];
+            s.address = w.address.toString();
+            s.userMs = rr.totalMs;
+            s.kernel = r->raceKernel;
+        }
+        else
+        {
+            s.kernel.monoNs = TcpInfo::monotonicNs();
+            s.userMs = static_cast<double>(s.kernel.monoNs - r->attemptStartNs) / 1e6;
+        }
+        finishTcpAttempt(id, s);
+    });
+
+    race->start(r->result.job.host, r->result.job.port);
+}
+
+void ProbeEngine::finishTcpAttempt(quint64 id, const TcpConnectSample& sample)
+{
+    Running* r = runningJob(id);
+    if (!r) return;
+
+    if (QTcpSocket* sock = r->sock)
+    {
+        r->sock = nullptr;
+        QObject::disconnect(sock, nullptr, r->ctx, nullptr);
+        if (sample.ok)
+        {
+            connect(sock, &QTcpSocket::disconnected, sock, &QObject::deleteLater);
+            sock->disconnectFromHost();
+        }
+        else
+        {
+            sock->abort();
+            sock->deleteLater();
+        }
+    }
+
+    r->result.tcp << sample;
+    emit tcpSample(id, sample);
+
+    r = runningJob(id);
+    if (!r) return;
+
+    if (r->remaining > 0)
+    {
+        const int delayMs = static_cast<int>(r->result.job.ping.intervalSec * 1000.0);
+        QTimer::singleShot(delayMs, r->ctx, [this, id]() { startTcpAttempt(id); });
+        return;
+    }
+
+    for (const auto& t : r->result.tcp)
+        r->result.ok = r->result.ok || t.ok;
+    complete(id);
+}
+
+void ProbeEngine::startDns(quint64 id)
+{
+    emit started(id, runningJob(id)->result.job, QString());
+    Running* r = runningJob(id);
+    if (!r) return;
+
+    QHostInfo::lookupHost(r->result.job.host, r->ctx, [this, id](const QHostInfo& info)
+    {
+        Running* r = runningJob(id);
+        if (!r) return;
+
+        if (info.error() != QHostInfo::NoError)
+        {
+            r->result.error = info.errorString();
+            complete(id);
+            return;
+        }
+
+        for (const auto& addr : info.addresses())
+            r->result.addresses << addr.toString();
+        r->result.ok = true;
+
+        if (r->result.addresses.isEmpty())
+        {
+            complete(id);
+            return;
+        }
+
+        // Reverse lookup for first address
+        QHostInfo::lookupHost(r->result.addresses.first(), r->ctx, [this, id](const QHostInfo& rev)
+        {
+            Running* r = runningJob(id);
+            if (!r) return;
+            if (rev.error() == QHostInfo::NoError)
+                r->result.reverseName = rev.hostName();
+            else
+                r->result.reverseError = rev.errorString();
+            complete(id);
+        });
+    });
+}
+
+void ProbeEngine::addHops(quint64 id, const QVector<TraceHop>& hops)
+{
+    for (TraceHop hop : hops)
+    {
+        Running* r = runningJob(id);
+        if (!r) return;
+
+        hop.resolved = !hop.address.isEmpty() && reverseDns_.cached(hop.address, &hop.hostName);
+        const bool known = hop.address.isEmpty() || hop.resolved;
+        const int index = r->result.hops.size();
+        r->result.hops << hop;
+        emit hopParsed(id, hop);
+
+        if (!known)
+        {
+            HopWaiter w;
+            w.id = id;
+            w.index = index;
+            w.hop = hop;
+            hopWaiters_.insert(hop.address, w);
+            reverseDns_.resolve(hop.address);
+        }
+    }
+}
+
+void ProbeEngine::onReverseResolved(const QString& address, const QString& name)
+{
+    const QList<HopWaiter> waiters = hopWaiters_.values(address);
+    hopWaiters_.remove(address);
+
+    for (HopWaiter w : waiters)
+    {
+        w.hop.hostName = name;
+        w.hop.resolved = true;
+        if (Running* r = runningJob(w.id))
+        {
+            if (w.index < r->result.hops.size())
+            {
+                r->result.hops[w.index].hostName = name;
+                r->result.hops[w.index].resolved = true;
+            }
+        }
+        emit hopResolved(w.id, w.hop);
+    }
+}
+
+void ProbeEngine::complete(quint64 id)
+{
+    const auto it = running_.find(id);
+    if (it == running_.end()) return;
+
+    std::unique_ptr<Running> r = std::move(it->second);
+    running_.erase(it);
+
+    bool reaping = false;
+    if (r->proc)
+    {
+        QObject::disconnect(r->proc, nullptr, r->ctx, nullptr);
+        if (r->proc->state() != QProcess::NotRunning)
+        {
+            // Keep the QProcess until the killed child has been reaped;
+            // destroying it while running blocks in its destructor.
+            QObject* ctx = r->ctx;
+            connect(r->proc, &QProcess::finished, ctx, &QObject::deleteLater);
+            connect(r->proc, &QProcess::errorOccurred, ctx, [ctx](QProcess::ProcessError err)
+            {
+                if (err == QProcess::FailedToStart) ctx->deleteLater();
+            });
+            r->proc->kill();
+            reaping = true;
+        }
+    }
+    if (r->sock)
+    {
+        QObject::disconnect(r->sock, nullptr, r->ctx, nullptr);
+        r->sock->abort();
+    }
+    if (r->race)
+    {
+        QObject::disconnect(r->race, nullptr, r->ctx, nullptr);
+        r->race->abort();
+    }
+    if (!reaping)
+        r->ctx->deleteLater();
+
+    if (r->result.job.kind == ProbeKind::Ping)
+        r->result.stats = PingOutputParser::parse(r->result.output);
+    else if (r->result.job.kind == ProbeKind::TcpConnect)
+        r->result.stats = tcpStats(r->result.tcp);
+
+    emit finished(r->result);
+    if (r->callback) r->callback(r->result);
+
+    startQueued();
+    if (isIdle()) emit idle();
+}
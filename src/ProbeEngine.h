@@ -0,0 +1,136 @@
+#pragma once
+#include <QList>
+#include <QMultiHash>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <functional>
+#include <map>
+#include <memory>
+
+#include "DualStackConnector.h"
+#include "PingCommandBuilder.h"
+#include "PingOutputParser.h"
+#include "ReverseDnsCache.h"
+#include "TcpInfo.h"
+#include "TracerouteParser.h"
+
+enum class ProbeKind
+{
+    Ping,
+    Traceroute,
+    TcpConnect,
+    Dns
+};
+
+struct ProbeJob
+{
+    ProbeKind kind = ProbeKind::Ping;
+    QString host;
+    PingOptions ping;   // Ping/Traceroute; TcpConnect uses count, intervalSec, timeoutMs
+    quint16 port = 443; // TcpConnect
+    AddressFamily family = AddressFamily::Any; // TcpConnect; Ping/Traceroute use ping.family
+};
+
+struct TcpConnectSample
+{
+    bool ok = false;
+    double userMs = -1.0;  // connectToHost() -> connected(), as seen by the event loop
+    QString error;
+    QString address;       // remote address actually connected to
+    TcpInfoSample kernel;  // kernel view right after the handshake
+    bool raced = false;    // DualStack: race holds both families' attempts
+    RaceResult race;
+};
+
+struct ProbeResult
+{
+    quint64 id = 0;
+    ProbeJob job;
+    bool ok = false;
+    bool cancelled = false;
+    QString error;
+
+    QString output;                 // Ping/Traceroute: raw command output
+    QVector<TraceHop> hops;         // Traceroute: names as far as resolved at finish time
+    PingStats stats;                // Ping: parsed summary; TcpConnect: aggregate over attempts
+    QVector<TcpConnectSample> tcp;  // TcpConnect: one entry per attempt
+    QStringList addresses;          // Dns
+    QString reverseName;            // Dns: PTR of the first address
+    QString reverseError;
+};
+
+using ProbeCallback = std::function<void(const ProbeResult&)>;
+
+// Asynchronous probe runner, independent of any UI. Jobs are queued FIFO and
+// at most maxConcurrent() run at once. Every submitted job produces exactly
+// one finished() signal (and callback), also when cancelled. Must be used
+// from a thread with a running Qt event loop.
+class ProbeEngine final : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ProbeEngine(QObject* parent = nullptr);
+    ~ProbeEngine() override;
+
+    void setMaxConcurrent(int n);
+    int maxConcurrent() const { return maxConcurrent_; }
+
+    // Shared cache behind traceroute hop names.
+    ReverseDnsCache& reverseDns() { return reverseDns_; }
+
+    // Returns the job id; the job starts on the next event-loop iteration.
+    quint64 submit(const ProbeJob& job, ProbeCallback onFinished = {});
+    bool cancel(quint64 id);
+    void cancelAll();
+
+    bool isIdle() const { return running_.empty() && queue_.isEmpty(); }
+    int pendingCount() const { return static_cast<int>(running_.size()) + queue_.size(); }
+
+signals:
+    void started(quint64 id, const ProbeJob& job, const QString& commandLine);
+    void output(quint64 id, const QString& chunk);
+    void tcpSample(quint64 id, const TcpConnectSample& sample);
+    void hopParsed(quint64 id, const TraceHop& hop);
+    // May arrive after finished(): names never hold up the trace.
+    void hopResolved(quint64 id, const TraceHop& hop);
+    void finished(const ProbeResult& result);
+    void idle();
+
+private:
+    struct Pending
+    {
+        quint64 id = 0;
+        ProbeJob job;
+        ProbeCallback callback;
+    };
+    struct Running;
+    struct HopWaiter
+    {
+        quint64 id = 0;
+        int index = 0;
+        TraceHop hop;
+    };
+
+    Running* runningJob(quint64 id) const;
+    void startQueued();
+    void startProcess(quint64 id, const Command& cmd);
+    void startTcp(quint64 id);
+    void startTcpAttempt(quint64 id);
+    void startTcpRace(quint64 id);
+    void finishTcpAttempt(quint64 id, const TcpConnectSample& sample);
+    void startDns(quint64 id);
+    void addHops(quint64 id, const QVector<TraceHop>& hops);
+    void onReverseResolved(const QString& address, const QString& name);
+    void complete(quint64 id);
+
+    int maxConcurrent_ = 1;
+    quint64 nextId_ = 0;
+    QList<Pending> queue_;
+    std::map<quint64, std::unique_ptr<Running>> running_;
+    ReverseDnsCache reverseDns_;
+    QMultiHash<QString, HopWaiter> hopWaiters_;
+};
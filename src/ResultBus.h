@@ -0,0 +1,260 @@
+#pragma once
+// Shared-memory result bus: layout and a reader for external consumers.
+//
+// Self-contained (standard C++17 plus the OS mapping API, no Qt), so local
+// dashboards and alerting sidecars can copy this one header.
+//
+// One PingTool process publishes fixed-size probe results into a ring of
+// power-of-two capacity in a named shared-memory object (/dev/shm/<name> on
+// Linux). Any number of readers map it read-only and follow the writer with
+// plain loads: no syscalls or locks once open, and the publisher never waits
+// for a reader. Each slot is a seqlock, so a reader that falls a full ring
+// behind detects it, skips ahead and counts what it missed.
+//
+//     ResultBusReader bus;
+//     if (bus.open())
+//         for (;;) {
+//             bus.drain([](const ResultBusRecord& r) { ... });
+//             // sleep / do other work
+//         }
+//
+// Target ids are resultBusTargetId(host name), the same on both sides.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(_WIN32)
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+#if defined(_WIN32)
+static constexpr const char* kResultBusDefaultName = "Local\\pingtool-results";
+#else
+static constexpr const char* kResultBusDefaultName = "/pingtool-results";
+#endif
+
+static constexpr uint32_t kResultBusMagic = 0x42525450;  // "PTRB"
+static constexpr uint16_t kResultBusVersion = 1;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "result bus needs lock-free 64-bit atomics");
+
+enum ResultBusStatus : uint8_t
+{
+    ResultBusReply = 0,
+    ResultBusLoss = 1,
+    ResultBusError = 2
+};
+
+// FNV-1a over the host name as given to the prober (UTF-8).
+inline uint32_t resultBusTargetId(const char* name, size_t len)
+{
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; ++i)
+    {
+        h ^= static_cast<uint8_t>(name[i]);
+        h *= 16777619u;
+    }
+    return h;
+}
+
+inline uint32_t resultBusTargetId(const char* name)
+{
+    return resultBusTargetId(name, std::strlen(name));
+}
+
+// Shared layout. The header is followed by `capacity` slots; record n lives
+// in slot n & (capacity - 1).
+struct ResultBusHeader
+{
+    std::atomic<uint32_t> magic;     // stored last by the publisher
+    uint16_t version;
+    uint16_t slotSize;
+    uint32_t capacity;               // power of two
+    std::atomic<uint32_t> live;      // 1 while the publisher has the bus open
+    uint32_t ownerPid;               // publisher process, to tell a crashed one from a live one
+    alignas(64) std::atomic<uint64_t> writeSeq;  // records published so far
+    char pad[56];
+};
+
+struct ResultBusSlot
+{
+    std::atomic<uint64_t> seq;       // 2n+1 while record n is written, 2n+2 once complete
+    std::atomic<uint64_t> target;    // target id | status << 32
+    std::atomic<int64_t> timestampNs;  // wall clock, ns since the Unix epoch
+    std::atomic<int64_t> rttNs;      // 0 unless status is ResultBusReply
+};
+
+static_assert(sizeof(ResultBusHeader) == 128, "result bus header layout");
+static_assert(sizeof(ResultBusSlot) == 32, "result bus slot layout");
+
+struct ResultBusRecord
+{
+    uint64_t seq = 0;                // publication index, gap-free unless lost
+    uint32_t targetId = 0;
+    uint8_t status = ResultBusReply;
+    int64_t timestampNs = 0;
+    int64_t rttNs = 0;
+};
+
+class ResultBusReader
+{
+public:
+    ResultBusReader() = default;
+    ~ResultBusReader() { close(); }
+    ResultBusReader(const ResultBusReader&) = delete;
+    ResultBusReader& operator=(const ResultBusReader&) = delete;
+
+    // Maps the bus read-only and positions at the oldest record still held.
+    bool open(const char* name = kResultBusDefaultName)
+    {
+        close();
+#if defined(_WIN32)
+        mapping_ = OpenFileMappingA(FILE_MAP_READ, FALSE, name);
+        if (!mapping_) return false;
+        base_ = MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0);
+        MEMORY_BASIC_INFORMATION mbi;
+        size_ = (base_ && VirtualQuery(base_, &mbi, sizeof(mbi))) ? mbi.RegionSize : 0;
+#else
+        const int fd = shm_open(name, O_RDONLY, 0);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size >= static_cast<off_t>(sizeof(ResultBusHeader)))
+        {
+            size_ = static_cast<size_t>(st.st_size);
+            base_ = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+            if (base_ == MAP_FAILED) base_ = nullptr;
+        }
+        ::close(fd);
+#endif
+        if (!base_ || size_ < sizeof(ResultBusHeader))
+        {
+            close();
+            return false;
+        }
+
+        header_ = static_cast<const ResultBusHeader*>(base_);
+        const uint32_t cap = header_->capacity;
+        if (header_->magic.load(std::memory_order_acquire) != kResultBusMagic
+            || header_->version != kResultBusVersion
+            || header_->slotSize != sizeof(ResultBusSlot)
+            || cap == 0 || (cap & (cap - 1)) != 0
+            || size_ < sizeof(ResultBusHeader) + size_t(cap) * sizeof(ResultBusSlot))
+        {
+            close();
+            return false;
+        }
+
+        slots_ = reinterpret_cast<const ResultBusSlot*>(header_ + 1);
+        mask_ = cap - 1;
+        lost_ = 0;
+        seekToOldest();
+        return true;
+    }
+
+    void close()
+    {
+#if defined(_WIN32)
+        if (base_) UnmapViewOfFile(base_);
+        if (mapping_) CloseHandle(mapping_);
+        mapping_ = nullptr;
+#else
+        if (base_) munmap(base_, size_);
+#endif
+        base_ = nullptr;
+        size_ = 0;
+        header_ = nullptr;
+        slots_ = nullptr;
+    }
+
+    bool isOpen() const { return header_ != nullptr; }
+
+    // False once the publisher has closed the bus; reopen to follow a new one.
+    bool publisherLive() const { return header_ && header_->live.load(std::memory_order_relaxed) != 0; }
+
+    uint64_t published() const { return header_->writeSeq.load(std::memory_order_acquire); }
+    uint32_t capacity() const { return mask_ + 1; }
+
+    void seekToLatest() { next_ = published(); }
+    void seekToOldest()
+    {
+        const uint64_t w = published();
+        next_ = w > capacity() ? w - capacity() : 0;
+    }
+
+    // Copies out the next record; false if the reader has caught up.
+    bool next(ResultBusRecord& out)
+    {
+        for (;;)
+        {
+            const uint64_t w = published();
+            if (next_ >= w) return false;
+            if (w - next_ > capacity())
+            {
+                lost_ += w - capacity() - next_;
+                next_ = w - capacity();
+            }
+
+            const ResultBusSlot& s = slots_[next_ & mask_];
+            const uint64_t want = 2 * next_ + 2;
+            if (s.seq.load(std::memory_order_acquire) == want)
+            {
+                const uint64_t target = s.target.load(std::memory_order_relaxed);
+                const int64_t ts = s.timestampNs.load(std::memory_order_relaxed);
+                const int64_t rtt = s.rttNs.load(std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (s.seq.load(std::memory_order_relaxed) == want)
+                {
+                    out.seq = next_++;
+                    out.targetId = static_cast<uint32_t>(target);
+                    out.status = static_cast<uint8_t>(target >> 32);
+                    out.timestampNs = ts;
+                    out.rttNs = rtt;
+                    return true;
+                }
+            }
+
+            // The publisher lapped us on this slot while we read it.
+            ++lost_;
+            ++next_;
+        }
+    }
+
+    // Calls fn for every available record (up to max); returns the count.
+    template <class Fn>
+    size_t drain(Fn&& fn, size_t max = SIZE_MAX)
+    {
+        size_t n = 0;
+        ResultBusRecord r;
+        while (n < max && next(r))
+        {
+            fn(r);
+            ++n;
+        }
+        return n;
+    }
+
+    // Records overwritten before this reader got to them.
+    uint64_t lost() const { return lost_; }
+
+private:
+    void* base_ = nullptr;
+    size_t size_ = 0;
+#if defined(_WIN32)
+    HANDLE mapping_ = nullptr;
+#endif
+    const ResultBusHeader* header_ = nullptr;
+    const ResultBusSlot* slots_ = nullptr;
+    uint32_t mask_ = 0;
+    uint64_t next_ = 0;
+    uint64_t lost_ = 0;
+};
@@ -0,0 +1,204 @@
+#include "ResultBusPublisher.h"
+
+#include <QtMath>
+
+#include <chrono>
+#include <cmath>
+#include <new>
+
+#include <cstring>
+
+#if !defined(_WIN32)
+#include <cerrno>
+#include <csignal>
+#endif
+
+ResultBusPublisher::~ResultBusPublisher()
+{
+    close();
+}
+
+#if !defined(_WIN32)
+// True if `name` is a bus whose publisher is still running. A publisher that
+// crashed leaves live set, so the owning process is checked as well.
+static bool busInUse(const char* name)
+{
+    const int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) return false;
+
+    bool inUse = false;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size >= off_t(sizeof(ResultBusHeader)))
+    {
+        void* p = mmap(nullptr, sizeof(ResultBusHeader), PROT_READ, MAP_SHARED, fd, 0);
+        if (p != MAP_FAILED)
+        {
+            const auto* h = static_cast<const ResultBusHeader*>(p);
+            inUse = h->magic.load(std::memory_order_acquire) == kResultBusMagic
+                && h->live.load(std::memory_order_relaxed) != 0
+                && (::kill(pid_t(h->ownerPid), 0) == 0 || errno == EPERM);
+            munmap(p, sizeof(ResultBusHeader));
+        }
+    }
+    ::close(fd);
+    return inUse;
+}
+#endif
+
+bool ResultBusPublisher::open(const QString& name, quint32 capacity, QString* error)
+{
+    close();
+
+    capacity = qNextPowerOfTwo(qBound<quint32>(64, capacity, kMaxCapacity) - 1);
+    const size_t size = sizeof(ResultBusHeader) + size_t(capacity) * sizeof(ResultBusSlot);
+    const QByteArray nativeName = name.toLocal8Bit();
+
+#if defined(_WIN32)
+    mapping_ = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                  DWORD(quint64(size) >> 32), DWORD(size), nativeName.constData());
+    const bool existed = mapping_ && GetLastError() == ERROR_ALREADY_EXISTS;
+    if (mapping_)
+        base_ = MapViewOfFile(mapping_, FILE_MAP_ALL_ACCESS, 0, 0, existed ? 0 : size);
+    if (!base_)
+    {
+        if (error) *error = QString("cannot map %1 (error %2)").arg(name).arg(GetLastError());
+        close();
+        return false;
+    }
+    if (existed)
+    {
+        // The name outlives a publisher only while readers hold it open;
+        // such a bus can be reused, one with a live publisher cannot.
+        MEMORY_BASIC_INFORMATION mbi = {};
+        const auto* h = static_cast<const ResultBusHeader*>(base_);
+        const bool fits = VirtualQuery(base_, &mbi, sizeof(mbi)) && mbi.RegionSize >= size;
+        if (!fits || h->live.load(std::memory_order_relaxed) != 0)
+        {
+            if (error) *error = fits ? QString("%1 is already published by another process").arg(name)
+                                     : QString("%1 is still open with a smaller capacity").arg(name);
+            close();
+            return false;
+        }
+        std::memset(base_, 0, size);
+    }
+#else
+    int fd = shm_open(nativeName.constData(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0 && errno == EEXIST)
+    {
+        if (busInUse(nativeName.constData()))
+        {
+            if (error) *error = QString("%1 is already published by another process").arg(name);
+            return false;
+        }
+        // Left behind by a publisher that died: readers still mapping it keep the old object.
+        shm_unlink(nativeName.constData());
+        fd = shm_open(nativeName.constData(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    }
+    struct stat st;
+    if (fd >= 0 && ftruncate(fd, off_t(size)) == 0 && fstat(fd, &st) == 0)
+    {
+        base_ = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (base_ == MAP_FAILED) base_ = nullptr;
+    }
+    const int err = errno;
+    if (fd >= 0) ::close(fd);
+    if (!base_)
+    {
+        if (error) *error = QString("cannot map %1: %2").arg(name, QString::fromLocal8Bit(std::strerror(err)));
+        if (fd >= 0) shm_unlink(nativeName.constData());
+        return false;
+    }
+    dev_ = st.st_dev;
+    ino_ = st.st_ino;
+#endif
+
+    name_ = name;
+    size_ = size;
+
+    // The mapping starts zeroed, so every slot sequence reads "never written".
+    header_ = new (base_) ResultBusHeader;
+    header_->version = kResultBusVersion;
+    header_->slotSize = sizeof(ResultBusSlot);
+    header_->capacity = capacity;
+#if defined(_WIN32)
+    header_->ownerPid = GetCurrentProcessId();
+#else
+    header_->ownerPid = uint32_t(getpid());
+#endif
+    header_->live.store(1, std::memory_order_relaxed);
+    header_->writeSeq.store(0, std::memory_order_relaxed);
+    slots_ = reinterpret_cast<ResultBusSlot*>(header_ + 1);
+    mask_ = capacity - 1;
+    writeSeq_ = 0;
+    header_->magic.store(kResultBusMagic, std::memory_order_release);
+    return true;
+}
+
+void ResultBusPublisher::close()
+{
+    if (header_)
+        header_->live.store(0, std::memory_order_release);
+
+#if defined(_WIN32)
+    if (base_) UnmapViewOfFile(base_);
+    if (mapping_) CloseHandle(mapping_);
+    mapping_ = nullptr;
+#else
+    if (base_)
+    {
+        munmap(base_, size_);
+
+        // Only remove the name if it still refers to the object this
+        // publisher created, not one a later publisher put there.
+        const QByteArray nativeName = name_.toLocal8Bit();
+        const int fd = shm_open(nativeName.constData(), O_RDONLY, 0);
+        struct stat st;
+        if (fd >= 0 && fstat(fd, &st) == 0 && st.st_dev == dev_ && st.st_ino == ino_)
+            shm_unlink(nativeName.constData());
+        if (fd >= 0) ::close(fd);
+    }
+    dev_ = 0;
+    ino_ = 0;
+#endif
+    base_ = nullptr;
+    size_ = 0;
+    header_ = nullptr;
+    slots_ = nullptr;
+}
+
+void ResultBusPublisher::publish(quint32 targetId, qint64 timestampNs, qint64 rttNs, ResultBusStatus status)
+{
+    if (!header_) return;
+
+    // Seqlock write: odd sequence, payload, even sequence, then advance the
+    // ring head. Readers that raced with the payload see the odd value.
+    const quint64 n = writeSeq_++;
+    ResultBusSlot& s = slots_[n & mask_];
+    s.seq.store(2 * n + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    s.target.store(quint64(targetId) | (quint64(status) << 32), std::memory_order_relaxed);
+    s.timestampNs.store(timestampNs, std::memory_order_relaxed);
+    s.rttNs.store(rttNs, std::memory_order_relaxed);
+    s.seq.store(2 * n + 2, std::memory_order_release);
+    header_->writeSeq.store(writeSeq_, std::memory_order_release);
+}
+
+void ResultBusPublisher::publish(const QString& target, bool replied, double rttMs)
+{
+    if (!header_) return;
+
+    const qint64 rttNs = (replied && rttMs >= 0) ? qint64(std::llround(rttMs * 1e6)) : 0;
+    publish(targetId(target), nowNs(), rttNs, replied ? ResultBusReply : ResultBusLoss);
+}
+
+quint32 ResultBusPublisher::targetId(const QString& name)
+{
+    const QByteArray utf8 = name.toUtf8();
+    return resultBusTargetId(utf8.constData(), size_t(utf8.size()));
+}
+
+qint64 ResultBusPublisher::nowNs()
+{
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(system_clock::now().time_since_epoch()).count();
+}
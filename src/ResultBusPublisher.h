@@ -0,0 +1,49 @@
+#pragma once
+#include <QString>
+#include <QtGlobal>
+
+#include "ResultBus.h"
+
+// Producer side of the shared-memory result bus (see ResultBus.h).
+// publish() is a handful of stores into the mapping: no locks, no syscalls,
+// nothing that waits for readers. Use from a single thread.
+class ResultBusPublisher
+{
+public:
+    ResultBusPublisher() = default;
+    ~ResultBusPublisher();
+    Q_DISABLE_COPY(ResultBusPublisher)
+
+    static constexpr quint32 kMaxCapacity = 1u << 24;  // 512 MiB of slots
+
+    // Creates the named bus; capacity is clamped to [64, kMaxCapacity] and
+    // rounded up to a power of two. Fails if another running publisher owns
+    // the name; a crashed one's is replaced.
+    bool open(const QString& name = QString::fromLatin1(kResultBusDefaultName),
+              quint32 capacity = 65536, QString* error = nullptr);
+    void close();
+    bool isOpen() const { return header_ != nullptr; }
+    const QString& name() const { return name_; }
+
+    void publish(quint32 targetId, qint64 timestampNs, qint64 rttNs, ResultBusStatus status);
+    // Stamps the current wall-clock time.
+    void publish(const QString& target, bool replied, double rttMs);
+
+    static quint32 targetId(const QString& name);
+    static qint64 nowNs();
+
+private:
+    QString name_;
+    void* base_ = nullptr;
+    size_t size_ = 0;
+#if defined(_WIN32)
+    HANDLE mapping_ = nullptr;
+#else
+    dev_t dev_ = 0;  // identity of the object created, checked before unlinking
+    ino_t ino_ = 0;
+#endif
+    ResultBusHeader* header_ = nullptr;
+    ResultBusSlot* slots_ = nullptr;
+    quint32 mask_ = 0;
+    quint64 writeSeq_ = 0;
+};
@@ -0,0 +1,154 @@
+#include "ResultProtocol.h"
+
+#include <QDataStream>
+#include <QtEndian>
+
+// The wire format must not follow whatever Qt the peer was built with.
+static void pinFormat(QDataStream& s)
+{
+    s.setVersion(QDataStream::Qt_6_0);
+    s.setByteOrder(QDataStream::LittleEndian);
+}
+
+static QByteArray frame(ResultFrameType type, const QByteArray& payload)
+{
+    QByteArray out;
+    out.reserve(5 + payload.size());
+    QDataStream s(&out, QIODevice::WriteOnly);
+    pinFormat(s);
+    s << quint32(payload.size() + 1) << quint8(type);
+    out.append(payload);
+    return out;
+}
+
+static QByteArray seqFrame(ResultFrameType type, quint64 seq)
+{
+    QByteArray p;
+    QDataStream s(&p, QIODevice::WriteOnly);
+    pinFormat(s);
+    s << seq;
+    return frame(type, p);
+}
+
+QByteArray ResultProtocol::encodeHello(const ResultHello& hello)
+{
+    QByteArray p;
+    QDataStream s(&p, QIODevice::WriteOnly);
+    pinFormat(s);
+    s << kMagic << kVersion << hello.agentId.toUtf8() << hello.epoch;
+    return frame(ResultFrameType::Hello, p);
+}
+
+QByteArray ResultProtocol::encodeHelloAck(quint64 lastSeq)
+{
+    return seqFrame(ResultFrameType::HelloAck, lastSeq);
+}
+
+QByteArray ResultProtocol::encodeTargets(const QVector<ResultTarget>& targets)
+{
+    QByteArray p;
+    QDataStream s(&p, QIODevice::WriteOnly);
+    pinFormat(s);
+    s << quint32(targets.size());
+    for (const auto& t : targets)
+        s << t.id << t.name.toUtf8();
+    return frame(ResultFrameType::Targets, p);
+}
+
+QByteArray ResultProtocol::encodeBatch(quint64 firstSeq, const QVector<ResultRecord>& records)
+{
+    QByteArray p;
+    p.reserve(12 + records.size() * kRecordBytes);
+    QDataStream s(&p, QIODevice::WriteOnly);
+    pinFormat(s);
+    s << firstSeq << quint32(records.size());
+    for (const auto& r : records)
+        s << r.targetId << r.timestampMs << r.rttUs << quint8(r.status);
+    return frame(ResultFrameType::Batch, p);
+}
+
+QByteArray ResultProtocol::encodeAck(quint64 seq)
+{
+    return seqFrame(ResultFrameType::Ack, seq);
+}
+
+ResultProtocol::Take ResultProtocol::takeFrame(QByteArray& buf, ResultFrameType* type, QByteArray* payload)
+{
+    if (buf.size() < 4)
+        return Take::NeedMore;
+
+    const quint32 len = qFromLittleEndian<quint32>(buf.constData());
+    if (len == 0 || len > quint32(kMaxFrameBytes))
+        return Take::Invalid;
+    if (buf.size() < 4 + qsizetype(len))
+        return Take::NeedMore;
+
+    *type = static_cast<ResultFrameType>(static_cast<quint8>(buf.at(4)));
+    *payload = buf.mid(5, len - 1);
+    buf.remove(0, 4 + len);
+    return Take::Frame;
+}
+
+bool ResultProtocol::decodeHello(const QByteArray& payload, ResultHello* hello)
+{
+    QDataStream s(payload);
+    pinFormat(s);
+    quint32 magic = 0;
+    quint16 version = 0;
+    QByteArray id;
+    s >> magic >> version >> id >> hello->epoch;
+    if (s.status() != QDataStream::Ok || magic != kMagic || version != kVersion || id.isEmpty())
+        return false;
+    hello->agentId = QString::fromUtf8(id);
+    return true;
+}
+
+bool ResultProtocol::decodeSeq(const QByteArray& payload, quint64* seq)
+{
+    QDataStream s(payload);
+    pinFormat(s);
+    s >> *seq;
+    return s.status() == QDataStream::Ok;
+}
+
+bool ResultProtocol::decodeTargets(const QByteArray& payload, QVector<ResultTarget>* targets)
+{
+    QDataStream s(payload);
+    pinFormat(s);
+    quint32 count = 0;
+    s >> count;
+    // Each entry is at least an id and an empty name.
+    if (s.status() != QDataStream::Ok || count > quint32(payload.size() / 8))
+        return false;
+
+    targets->clear();
+    targets->reserve(count);
+    for (quint32 i = 0; i < count; ++i)
+    {
+        ResultTarget t;
+        QByteArray name;
+        s >> t.id >> name;
+        t.name = QString::fromUtf8(name);
+        targets->push_back(t);
+    }
+    return s.status() == QDataStream::Ok;
+}
+
+bool ResultProtocol::decodeBatch(const QByteArray& payload, quint64* firstSeq, QVector<ResultRecord>* records)
+{
+    QDataStream s(payload);
+    pinFormat(s);
+    quint32 count = 0;
+    s >> *firstSeq >> count;
+    if (s.status() != QDataStream::Ok || payload.size() != 12 + qint64(count) * kRecordBytes)
+        return false;
+
+    records->resize(count);
+    for (auto& r : *records)
+    {
+        quint8 status = 0;
+        s >> r.targetId >> r.timestampMs >> r.rttUs >> status;
+        r.status = static_cast<ResultStatus>(status);
+    }
+    return s.status() == QDataStream::Ok;
+}
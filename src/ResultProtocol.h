@@ -0,0 +1,85 @@
+#pragma once
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+#include <QtGlobal>
+
+// Agent <-> collector wire protocol, carried on one long-lived TCP
+// connection. Every frame is
+//     u32 length | u8 type | payload      (little-endian, length = 1 + payload)
+//
+//   agent                         collector
+//   Hello(agent id, epoch)   ->
+//                            <-   HelloAck(last seq stored for this epoch)
+//   Targets(id -> name)      ->
+//   Batch(first seq, recs)   ->
+//                            <-   Ack(highest seq stored)
+//
+// Sequence numbers count records, start at 1 per agent epoch (process run)
+// and let the agent resume after a reconnect without losing or duplicating
+// results.
+enum class ResultFrameType : quint8
+{
+    Hello = 1,
+    HelloAck = 2,
+    Targets = 3,
+    Batch = 4,
+    Ack = 5
+};
+
+enum class ResultStatus : quint8
+{
+    Reply = 0,
+    Loss = 1,
+    Error = 2
+};
+
+struct ResultRecord
+{
+    quint32 targetId = 0;
+    qint64 timestampMs = 0;  // wall clock, ms since the Unix epoch
+    quint32 rttUs = 0;       // 0 unless status is Reply
+    ResultStatus status = ResultStatus::Reply;
+};
+
+struct ResultHello
+{
+    QString agentId;
+    quint64 epoch = 0;  // random per agent run; a new epoch restarts sequence numbers
+};
+
+struct ResultTarget
+{
+    quint32 id = 0;
+    QString name;
+};
+
+class ResultProtocol
+{
+public:
+    static constexpr quint32 kMagic = 0x31525450;  // "PTR1"
+    static constexpr quint16 kVersion = 1;
+    static constexpr int kRecordBytes = 17;
+    static constexpr int kMaxFrameBytes = 8 * 1024 * 1024;
+
+    static QByteArray encodeHello(const ResultHello& hello);
+    static QByteArray encodeHelloAck(quint64 lastSeq);
+    static QByteArray encodeTargets(const QVector<ResultTarget>& targets);
+    static QByteArray encodeBatch(quint64 firstSeq, const QVector<ResultRecord>& records);
+    static QByteArray encodeAck(quint64 seq);
+
+    enum class Take
+    {
+        NeedMore,
+        Frame,
+        Invalid  // oversized or empty frame; drop the connection
+    };
+
+    // Removes one complete frame from the front of buf.
+    static Take takeFrame(QByteArray& buf, ResultFrameType* type, QByteArray* payload);
+
+    static bool decodeHello(const QByteArray& payload, ResultHello* hello);
+    static bool decodeSeq(const QByteArray& payload, quint64* seq);  // HelloAck, Ack
+    static bool decodeTargets(const QByteArray& payload, QVector<ResultTarget>* targets);
+    static bool decodeBatch(const QByteArray& payload, quint64* firstSeq, QVector<ResultRecord>* records);
+};
@@ -0,0 +1,40 @@
+#include "ReverseDnsCache.h"
+#include <QHostInfo>
+
+ReverseDnsCache::ReverseDnsCache(QObject* parent)
+    : QObject(parent)
+{
+}
+
+bool ReverseDnsCache::cached(const QString& address, QString* name) const
+{
+    const auto it = cache_.constFind(address);
+    if (it == cache_.constEnd()) return false;
+    if (name) *name = it.value();
+    return true;
+}
+
+void ReverseDnsCache::resolve(const QString& address)
+{
+    if (address.isEmpty() || cache_.contains(address) || inFlight_.contains(address))
+        return;
+
+    inFlight_.insert(address);
+    QHostInfo::lookupHost(address, this, [this, address](const QHostInfo& info)
+    {
+        inFlight_.remove(address);
+
+        // Without a PTR record Qt hands back the address itself.
+        QString name;
+        if (info.error() == QHostInfo::NoError && info.hostName() != address)
+            name = info.hostName();
+
+        cache_.insert(address, name);
+        emit resolved(address, name);
+    });
+}
+
+void ReverseDnsCache::clear()
+{
+    cache_.clear();
+}
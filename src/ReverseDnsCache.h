@@ -0,0 +1,32 @@
+#pragma once
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QString>
+
+// Asynchronous PTR lookups with de-duplication and an in-memory cache.
+// Lookups run on Qt's host-info thread pool, so several resolve in parallel
+// and none of them blocks the caller.
+class ReverseDnsCache final : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ReverseDnsCache(QObject* parent = nullptr);
+
+    // True if the address has been resolved before; name is empty when it has no PTR record.
+    bool cached(const QString& address, QString* name = nullptr) const;
+
+    // Starts a lookup unless the address is cached or already being resolved.
+    void resolve(const QString& address);
+
+    void clear();
+
+signals:
+    // Emitted once per lookup, also when it fails (name is then empty).
+    void resolved(const QString& address, const QString& name);
+
+private:
+    QHash<QString, QString> cache_;
+    QSet<QString> inFlight_;
+};
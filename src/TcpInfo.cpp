@@ -0,0 +1,69 @@
+#include "TcpInfo.h"
+
+#include <chrono>
+#include <cstddef>
+
+#if defined(Q_OS_WIN)
+#  include <winsock2.h>
+#  include <ws2tcpip.h>
+#  include <mstcpip.h>
+#elif defined(Q_OS_LINUX)
+#  include <netinet/in.h>
+#  include <sys/socket.h>
+#  include <linux/tcp.h>   // glibc's struct tcp_info lacks tcpi_min_rtt
+#elif defined(Q_OS_MACOS)
+#  include <netinet/in.h>
+#  include <netinet/tcp.h>
+#  include <sys/socket.h>
+#endif
+
+qint64 TcpInfo::monotonicNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+TcpInfoSample TcpInfo::read(qintptr socketDescriptor)
+{
+    TcpInfoSample s;
+    s.monoNs = monotonicNs();
+    if (socketDescriptor < 0)
+        return s;
+
+#if defined(Q_OS_WIN)
+    // Windows 10 1703+.
+    DWORD version = 0;
+    TCP_INFO_v0 info{};
+    DWORD bytes = 0;
+    if (WSAIoctl(static_cast<SOCKET>(socketDescriptor), SIO_TCP_INFO, &version, sizeof(version),
+                 &info, sizeof(info), &bytes, nullptr, nullptr) != 0)
+        return s;
+    s.valid = true;
+    s.srttUs = info.RttUs;
+    s.minRttUs = info.MinRttUs;
+    s.retransmits = static_cast<qint64>(info.FastRetrans) + info.TimeoutEpisodes + info.SynRetrans;
+#elif defined(Q_OS_LINUX)
+    tcp_info info{};
+    socklen_t len = sizeof(info);
+    if (::getsockopt(static_cast<int>(socketDescriptor), IPPROTO_TCP, TCP_INFO, &info, &len) != 0)
+        return s;
+    s.valid = true;
+    s.srttUs = info.tcpi_rtt;
+    s.rttVarUs = info.tcpi_rttvar;
+    s.retransmits = info.tcpi_total_retrans;
+    // Older kernels return a shorter struct without min_rtt.
+    if (len >= offsetof(tcp_info, tcpi_min_rtt) + sizeof(info.tcpi_min_rtt) && info.tcpi_min_rtt != ~0U)
+        s.minRttUs = info.tcpi_min_rtt;
+#elif defined(Q_OS_MACOS)
+    // macOS only reports millisecond resolution.
+    tcp_connection_info info{};
+    socklen_t len = sizeof(info);
+    if (::getsockopt(static_cast<int>(socketDescriptor), IPPROTO_TCP, TCP_CONNECTION_INFO, &info, &len) != 0)
+        return s;
+    s.valid = true;
+    s.srttUs = static_cast<qint64>(info.tcpi_srtt) * 1000;
+    s.rttVarUs = static_cast<qint64>(info.tcpi_rttvar) * 1000;
+    s.retransmits = static_cast<qint64>(info.tcpi_txretransmitpackets);
+#endif
+    return s;
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <QtGlobal>
+
+struct TcpInfoSample
+{
+    bool valid = false;
+    qint64 monoNs = 0;        // monotonic timestamp of the sample
+    qint64 srttUs = -1;       // kernel smoothed RTT
+    qint64 rttVarUs = -1;     // -1 where the platform does not report it
+    qint64 minRttUs = -1;
+    qint64 retransmits = -1;  // total retransmissions on this connection
+};
+
+class TcpInfo
+{
+public:
+    // Nanoseconds on a monotonic clock; only differences are meaningful.
+    static qint64 monotonicNs();
+
+    // Kernel TCP statistics for a connected socket (TCP_INFO on Linux,
+    // TCP_CONNECTION_INFO on macOS, SIO_TCP_INFO on Windows).
+    static TcpInfoSample read(qintptr socketDescriptor);
+};
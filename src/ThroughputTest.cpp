@@ -0,0 +1,629 @@
+#include "ThroughputTest.h"
+#include "TcpInfo.h"
+
+#include <QByteArray>
+#include <QEventLoop>
+#include <QHostAddress>
+#include <QTcpSocket>
+#include <QThread>
+#include <QTimer>
+#include <QtGlobal>
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+
+#if defined(Q_OS_WIN)
+#  include <windows.h>
+#elif defined(Q_OS_UNIX)
+#  include <csignal>
+#  include <pthread.h>
+#  include <sys/resource.h>
+#endif
+
+#if defined(Q_OS_LINUX)
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/sendfile.h>
+#  include <sys/socket.h>
+#  include <unistd.h>
+#endif
+
+struct ThroughputStream
+{
+    std::atomic<qint64> bytes{0};
+    std::atomic<qint64> retransmits{-1};  // cumulative, -1 if unknown
+    std::atomic<bool> connected{false};
+    std::atomic<bool> failed{false};
+    std::atomic<bool> done{false};
+    std::atomic<bool> stop{false};
+    QString error;                        // written before 'failed' is set
+
+    // Owner (GUI) thread only.
+    qint64 reportedBytes = 0;
+    qint64 reportedRetrans = 0;
+    bool errorReported = false;
+
+    void fail(const QString& e)
+    {
+        error = e;
+        failed.store(true, std::memory_order_release);
+    }
+};
+
+static double processCpuSeconds()
+{
+#if defined(Q_OS_WIN)
+    FILETIME created, exited, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user))
+        return -1.0;
+    auto toSec = [](const FILETIME& f)
+    {
+        ULARGE_INTEGER v;
+        v.LowPart = f.dwLowDateTime;
+        v.HighPart = f.dwHighDateTime;
+        return static_cast<double>(v.QuadPart) / 1e7;
+    };
+    return toSec(kernel) + toSec(user);
+#elif defined(Q_OS_UNIX)
+    rusage ru{};
+    if (getrusage(RUSAGE_SELF, &ru) != 0)
+        return -1.0;
+    return ru.ru_utime.tv_sec + ru.ru_utime.tv_usec / 1e6
+         + ru.ru_stime.tv_sec + ru.ru_stime.tv_usec / 1e6;
+#else
+    return -1.0;
+#endif
+}
+
+static double cpuPercent(double fromSec, double toSec, double wallSec)
+{
+    if (fromSec < 0.0 || toSec < 0.0 || wallSec <= 0.0)
+        return -1.0;
+    return (toSec - fromSec) * 100.0 / wallSec;
+}
+
+// Bytes/retransmits accumulated since the previous call, for every stream.
+static ThroughputInterval takeInterval(std::vector<std::unique_ptr<ThroughputStream>>& streams,
+                                       double startSec, double endSec, double& lastCpuSec)
+{
+    ThroughputInterval iv;
+    iv.startSec = startSec;
+    iv.endSec = endSec;
+
+    for (auto& st : streams)
+    {
+        const qint64 b = st->bytes.load(std::memory_order_relaxed);
+        const qint64 d = b - st->reportedBytes;
+        st->reportedBytes = b;
+        iv.streamBytes << d;
+        iv.totalBytes += d;
+
+        const qint64 r = st->retransmits.load(std::memory_order_relaxed);
+        if (r >= 0)
+        {
+            iv.retransmits = qMax<qint64>(iv.retransmits, 0) + (r - st->reportedRetrans);
+            st->reportedRetrans = r;
+        }
+    }
+
+    const double wall = endSec - startSec;
+    if (wall > 0.0)
+        iv.bitsPerSec = static_cast<double>(iv.totalBytes) * 8.0 / wall;
+
+    const double cpu = processCpuSeconds();
+    iv.cpuPct = cpuPercent(lastCpuSec, cpu, wall);
+    lastCpuSec = cpu;
+    return iv;
+}
+
+// Cumulative totals since the beginning of the run.
+static ThroughputInterval totalInterval(const std::vector<std::unique_ptr<ThroughputStream>>& streams,
+                                        double endSec, double startCpuSec)
+{
+    ThroughputInterval iv;
+    iv.endSec = endSec;
+    for (const auto& st : streams)
+    {
+        const qint64 b = st->bytes.load(std::memory_order_relaxed);
+        iv.streamBytes << b;
+        iv.totalBytes += b;
+        const qint64 r = st->retransmits.load(std::memory_order_relaxed);
+        if (r >= 0)
+            iv.retransmits = qMax<qint64>(iv.retransmits, 0) + r;
+    }
+    if (endSec > 0.0)
+        iv.bitsPerSec = static_cast<double>(iv.totalBytes) * 8.0 / endSec;
+    iv.cpuPct = cpuPercent(startCpuSec, processCpuSeconds(), endSec);
+    return iv;
+}
+
+static void joinAll(std::vector<std::unique_ptr<ThroughputStream>>& streams, std::vector<QThread*>& threads)
+{
+    for (auto& st : streams)
+        st->stop.store(true, std::memory_order_relaxed);
+    for (QThread* t : threads)
+    {
+        t->wait();
+        delete t;
+    }
+    threads.clear();
+}
+
+static void sampleRetransmits(qintptr fd, ThroughputStream& st)
+{
+    const TcpInfoSample info = TcpInfo::read(fd);
+    if (info.valid)
+        st.retransmits.store(info.retransmits, std::memory_order_relaxed);
+}
+
+#if defined(Q_OS_LINUX)
+
+// Qt keeps its sockets non-blocking; the zero-copy loops below run on a
+// dedicated thread and want blocking calls with a short timeout instead, so
+// they can still notice the stop flag.
+static int makeBlocking(int fd, int optName)
+{
+    const int flags = ::fcntl(fd, F_GETFL);
+    ::fcntl(fd, F_SETFL, flags & ~O_NONBLOCK);
+    timeval tv{0, 200 * 1000};
+    ::setsockopt(fd, SOL_SOCKET, optName, &tv, sizeof(tv));
+    return flags;
+}
+
+// A page-cache backed buffer that sendfile() can transmit without copying.
+static int patternMemfd(int bytes)
+{
+    const int fd = ::memfd_create("pingtool-throughput", MFD_CLOEXEC);
+    if (fd < 0) return -1;
+
+    QByteArray pattern(bytes, '\0');
+    for (int i = 0; i < bytes; ++i)
+        pattern[i] = static_cast<char>('a' + i % 26);
+
+    qint64 written = 0;
+    while (written < bytes)
+    {
+        const ssize_t n = ::write(fd, pattern.constData() + written, bytes - written);
+        if (n <= 0)
+        {
+            ::close(fd);
+            return -1;
+        }
+        written += n;
+    }
+    return fd;
+}
+
+// Returns false if sendfile() is not usable here, so the caller can fall back.
+static bool sendZeroCopy(int fd, ThroughputStream& st, const ThroughputOptions& opt)
+{
+    const int src = patternMemfd(opt.blockBytes);
+    if (src < 0) return false;
+
+    const int flags = makeBlocking(fd, SO_SNDTIMEO);
+    QElapsedTimer infoTimer;
+    infoTimer.start();
+
+    bool handled = true;
+    off_t off = 0;
+    while (!st.stop.load(std::memory_order_relaxed))
+    {
+        if (off >= opt.blockBytes) off = 0;
+        const ssize_t n = ::sendfile(fd, src, &off, static_cast<size_t>(opt.blockBytes - off));
+        if (n > 0)
+        {
+            st.bytes.fetch_add(n, std::memory_order_relaxed);
+        }
+        else if (n < 0 && (errno == EAGAIN || errno == EINTR))
+        {
+            // timeout: re-check the stop flag
+        }
+        else if (n < 0 && (errno == EINVAL || errno == ENOSYS) && st.bytes.load() == 0)
+        {
+            handled = false;
+            break;
+        }
+        else
+        {
+            st.fail(n < 0 ? QString::fromLocal8Bit(std::strerror(errno)) : QString("connection closed"));
+            break;
+        }
+
+        if (infoTimer.elapsed() >= 100)
+        {
+            sampleRetransmits(fd, st);
+            infoTimer.restart();
+        }
+    }
+
+    sampleRetransmits(fd, st);
+    ::close(src);
+    if (!handled) ::fcntl(fd, F_SETFL, flags);
+    return handled;
+}
+
+// socket -> pipe -> /dev/null, the payload never enters user space.
+static bool receiveSplice(int fd, ThroughputStream& st, const ThroughputOptions& opt)
+{
+    int pipefd[2];
+    if (::pipe2(pipefd, O_CLOEXEC) != 0) return false;
+    ::fcntl(pipefd[1], F_SETPIPE_SZ, qMax(opt.blockBytes, 1 << 20));
+
+    const int sink = ::open("/dev/null", O_WRONLY | O_CLOEXEC);
+    if (sink < 0)
+    {
+        ::close(pipefd[0]);
+        ::close(pipefd[1]);
+        return false;
+    }
+
+    const int flags = makeBlocking(fd, SO_RCVTIMEO);
+    bool handled = true;
+    while (!st.stop.load(std::memory_order_relaxed))
+    {
+        const ssize_t n = ::splice(fd, nullptr, pipefd[1], nullptr, static_cast<size_t>(opt.blockBytes),
+                                   SPLICE_F_MOVE | SPLICE_F_MORE);
+        if (n == 0) break; // peer closed
+        if (n < 0)
+        {
+            if (errno == EAGAIN || errno == EINTR) continue;
+            if (errno == EINVAL && st.bytes.load() == 0) handled = false;
+            else st.fail(QString::fromLocal8Bit(std::strerror(errno)));
+            break;
+        }
+
+        ssize_t left = n;
+        while (left > 0)
+        {
+            const ssize_t m = ::splice(pipefd[0], nullptr, sink, nullptr, static_cast<size_t>(left), SPLICE_F_MOVE);
+            if (m < 0 && errno == EINTR) continue;
+            if (m <= 0) break;
+            left -= m;
+        }
+        if (left > 0)
+        {
+            st.fail("splice to /dev/null failed");
+            break;
+        }
+        st.bytes.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    ::close(sink);
+    ::close(pipefd[0]);
+    ::close(pipefd[1]);
+    if (!handled) ::fcntl(fd, F_SETFL, flags);
+    return handled;
+}
+
+#endif // Q_OS_LINUX
+
+#if defined(Q_OS_UNIX)
+// sendfile() has no MSG_NOSIGNAL. Rather than ignoring SIGPIPE for the whole
+// process (this is library code), a sender thread blocks it and swallows any
+// instance still pending when it finishes.
+class SigpipeBlocker
+{
+public:
+    SigpipeBlocker()
+    {
+        sigemptyset(&set_);
+        sigaddset(&set_, SIGPIPE);
+        pthread_sigmask(SIG_BLOCK, &set_, &old_);
+    }
+
+    ~SigpipeBlocker()
+    {
+        sigset_t pending;
+        int sig = 0;
+        if (sigpending(&pending) == 0 && sigismember(&pending, SIGPIPE))
+            sigwait(&set_, &sig);
+        pthread_sigmask(SIG_SETMASK, &old_, nullptr);
+    }
+
+private:
+    sigset_t set_;
+    sigset_t old_;
+};
+#endif
+
+// waitForConnected() cannot be interrupted, so the connect runs in a local
+// event loop that also watches the stop flag; Stop never has to wait for it.
+static bool connectStream(QTcpSocket& sock, const QString& host, quint16 port, ThroughputStream& st)
+{
+    QEventLoop loop;
+    QTimer poll;
+    QElapsedTimer elapsed;
+    elapsed.start();
+    QObject::connect(&sock, &QTcpSocket::connected, &loop, &QEventLoop::quit);
+    QObject::connect(&sock, &QTcpSocket::errorOccurred, &loop, &QEventLoop::quit);
+    QObject::connect(&poll, &QTimer::timeout, &loop, [&]()
+    {
+        if (st.stop.load(std::memory_order_relaxed) || elapsed.elapsed() >= 5000)
+            loop.quit();
+    });
+    poll.start(50);
+
+    sock.connectToHost(host, port);
+    if (sock.state() == QAbstractSocket::HostLookupState || sock.state() == QAbstractSocket::ConnectingState)
+        loop.exec();
+    poll.stop();
+
+    if (sock.state() == QAbstractSocket::ConnectedState)
+        return true;
+
+    if (!st.stop.load(std::memory_order_relaxed))
+        st.fail(sock.state() == QAbstractSocket::UnconnectedState ? sock.errorString() : QString("connection timed out"));
+    sock.abort();
+    return false;
+}
+
+static void runSender(ThroughputStream& st, const QString& host, quint16 port, const ThroughputOptions& opt)
+{
+#if defined(Q_OS_UNIX)
+    const SigpipeBlocker noSigpipe;
+#endif
+
+    QTcpSocket sock;
+    if (!connectStream(sock, host, port, st))
+        return;
+    st.connected.store(true);
+
+    const qintptr fd = sock.socketDescriptor();
+#if defined(Q_OS_LINUX)
+    if (opt.zeroCopy && sendZeroCopy(static_cast<int>(fd), st, opt))
+        return;
+#endif
+
+    const QByteArray block(opt.blockBytes, 'x');
+    QElapsedTimer infoTimer;
+    infoTimer.start();
+    while (!st.stop.load(std::memory_order_relaxed) && sock.state() == QAbstractSocket::ConnectedState)
+    {
+        if (sock.bytesToWrite() < 4 * block.size())
+        {
+            const qint64 n = sock.write(block);
+            if (n < 0)
+            {
+                st.fail(sock.errorString());
+                return;
+            }
+            st.bytes.fetch_add(n, std::memory_order_relaxed);
+        }
+        sock.waitForBytesWritten(100);
+
+        if (infoTimer.elapsed() >= 100)
+        {
+            sampleRetransmits(fd, st);
+            infoTimer.restart();
+        }
+    }
+
+    sampleRetransmits(fd, st);
+}
+
+static void runReceiver(ThroughputStream& st, qintptr descriptor, const ThroughputOptions& opt)
+{
+#if defined(Q_OS_LINUX)
+    if (opt.zeroCopy && receiveSplice(static_cast<int>(descriptor), st, opt))
+    {
+        ::close(static_cast<int>(descriptor));
+        return;
+    }
+#endif
+
+    QTcpSocket sock;
+    if (!sock.setSocketDescriptor(descriptor))
+    {
+        st.fail(sock.errorString());
+        return;
+    }
+
+    QByteArray buf(opt.blockBytes, Qt::Uninitialized);
+    while (!st.stop.load(std::memory_order_relaxed))
+    {
+        if (sock.bytesAvailable() == 0 && !sock.waitForReadyRead(200))
+        {
+            if (sock.state() != QAbstractSocket::ConnectedState) break;
+            continue;
+        }
+        const qint64 n = sock.read(buf.data(), buf.size());
+        if (n < 0) break;
+        st.bytes.fetch_add(n, std::memory_order_relaxed);
+    }
+}
+
+// ---------------------------------------------------------------------------
+
+ThroughputClient::ThroughputClient(QObject* parent)
+    : QObject(parent)
+{
+    connect(&tick_, &QTimer::timeout, this, &ThroughputClient::onTick);
+}
+
+ThroughputClient::~ThroughputClient()
+{
+    joinAll(streams_, threads_);
+}
+
+void ThroughputClient::start(const QString& host, quint16 port, const ThroughputOptions& opt)
+{
+    if (isRunning()) return;
+
+    opt_ = opt;
+    opt_.streams = qMax(1, opt.streams);
+    opt_.blockBytes = qMax(4096, opt.blockBytes);
+    streams_.clear();
+    last_ = ThroughputInterval();
+    reportedConnected_ = false;
+
+    for (int i = 0; i < opt_.streams; ++i)
+    {
+        streams_.push_back(std::make_unique<ThroughputStream>());
+        ThroughputStream* st = streams_.back().get();
+        QThread* t = QThread::create([st, host, port, o = opt_]()
+        {
+            runSender(*st, host, port, o);
+            st->done.store(true);
+        });
+        threads_.push_back(t);
+        t->start();
+    }
+
+    clock_.start();
+    startCpuSec_ = lastCpuSec_ = processCpuSeconds();
+    tick_.start(opt_.reportIntervalMs);
+}
+
+void ThroughputClient::stop()
+{
+    if (isRunning()) finish();
+}
+
+void ThroughputClient::onTick()
+{
+    const double now = clock_.elapsed() / 1000.0;
+
+    bool allDone = true;
+    int connected = 0;
+    for (size_t i = 0; i < streams_.size(); ++i)
+    {
+        auto& st = streams_[i];
+        if (st->failed.load(std::memory_order_acquire) && !st->errorReported)
+        {
+            st->errorReported = true;
+            emit message(QString("Stream %1: %2").arg(i + 1).arg(st->error));
+        }
+        if (st->connected.load()) ++connected;
+        if (!st->done.load()) allDone = false;
+    }
+
+    if (!reportedConnected_ && connected == static_cast<int>(streams_.size()))
+    {
+        reportedConnected_ = true;
+        emit message(QString("Connected %1 stream(s)%2").arg(connected)
+            .arg(opt_.zeroCopy ? QString(" (zero-copy where supported)") : QString()));
+    }
+
+    const ThroughputInterval iv = takeInterval(streams_, last_.endSec, now, lastCpuSec_);
+    last_ = iv;
+    emit intervalReport(iv);
+
+    if (allDone || now >= opt_.durationSec)
+        finish();
+}
+
+void ThroughputClient::finish()
+{
+    tick_.stop();
+    joinAll(streams_, threads_);
+
+    const double now = clock_.elapsed() / 1000.0;
+    if (now - last_.endSec > 0.05)
+    {
+        last_ = takeInterval(streams_, last_.endSec, now, lastCpuSec_);
+        if (last_.totalBytes > 0)
+            emit intervalReport(last_);
+    }
+    for (size_t i = 0; i < streams_.size(); ++i)
+    {
+        auto& st = streams_[i];
+        if (st->failed.load(std::memory_order_acquire) && !st->errorReported)
+        {
+            st->errorReported = true;
+            emit message(QString("Stream %1: %2").arg(i + 1).arg(st->error));
+        }
+    }
+
+    emit finished(totalInterval(streams_, now, startCpuSec_));
+}
+
+// ---------------------------------------------------------------------------
+
+ThroughputServer::ThroughputServer(QObject* parent)
+    : QTcpServer(parent)
+{
+    connect(&tick_, &QTimer::timeout, this, &ThroughputServer::onTick);
+}
+
+ThroughputServer::~ThroughputServer()
+{
+    joinAll(streams_, threads_);
+}
+
+bool ThroughputServer::start(quint16 port, const ThroughputOptions& opt)
+{
+    opt_ = opt;
+    opt_.blockBytes = qMax(4096, opt.blockBytes);
+    if (!listen(QHostAddress::Any, port))
+        return false;
+    tick_.start(opt_.reportIntervalMs);
+    return true;
+}
+
+void ThroughputServer::stop()
+{
+    close();
+    tick_.stop();
+    joinAll(streams_, threads_);
+    streams_.clear();
+}
+
+void ThroughputServer::incomingConnection(qintptr socketDescriptor)
+{
+    if (streams_.empty())
+    {
+        // First stream of a new session.
+        clock_.start();
+        startCpuSec_ = lastCpuSec_ = processCpuSeconds();
+        last_ = ThroughputInterval();
+    }
+
+    streams_.push_back(std::make_unique<ThroughputStream>());
+    ThroughputStream* st = streams_.back().get();
+    st->connected.store(true);
+    QThread* t = QThread::create([st, socketDescriptor, o = opt_]()
+    {
+        runReceiver(*st, socketDescriptor, o);
+        st->done.store(true);
+    });
+    threads_.push_back(t);
+    t->start();
+
+    emit message(QString("Throughput server: stream %1 connected").arg(streams_.size()));
+}
+
+void ThroughputServer::onTick()
+{
+    if (streams_.empty()) return;
+
+    bool allDone = true;
+    for (size_t i = 0; i < streams_.size(); ++i)
+    {
+        auto& st = streams_[i];
+        if (st->failed.load(std::memory_order_acquire) && !st->errorReported)
+        {
+            st->errorReported = true;
+            emit message(QString("Stream %1: %2").arg(i + 1).arg(st->error));
+        }
+        if (!st->done.load()) allDone = false;
+    }
+
+    const double now = clock_.elapsed() / 1000.0;
+    const ThroughputInterval iv = takeInterval(streams_, last_.endSec, now, lastCpuSec_);
+    last_ = iv;
+    if (iv.totalBytes > 0)
+        emit intervalReport(iv);
+
+    if (allDone)
+    {
+        emit finished(totalInterval(streams_, now, startCpuSec_));
+        reapFinished();
+    }
+}
+
+void ThroughputServer::reapFinished()
+{
+    joinAll(streams_, threads_);
+    streams_.clear();
+}
@@ -0,0 +1,108 @@
+#pragma once
+#include <QElapsedTimer>
+#include <QObject>
+#include <QString>
+#include <QTcpServer>
+#include <QTimer>
+#include <QVector>
+
+#include <memory>
+#include <vector>
+
+class QThread;
+
+struct ThroughputOptions
+{
+    int streams = 1;              // parallel TCP connections
+    int durationSec = 10;         // client only
+    int reportIntervalMs = 1000;
+    int blockBytes = 128 * 1024;  // bytes per send/receive call
+    bool zeroCopy = true;         // sendfile()/splice() where available (Linux)
+};
+
+struct ThroughputInterval
+{
+    double startSec = 0.0;
+    double endSec = 0.0;
+    QVector<qint64> streamBytes;  // per stream, within the interval
+    qint64 totalBytes = 0;
+    double bitsPerSec = 0.0;
+    qint64 retransmits = -1;      // summed over streams; -1 if unavailable
+    double cpuPct = -1.0;         // process CPU; 100 = one core busy
+};
+
+// Per-connection state shared between a worker thread and the owning object.
+struct ThroughputStream;
+
+// Sender side: opens N parallel connections to a ThroughputServer and pushes
+// data for the configured duration.
+class ThroughputClient final : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ThroughputClient(QObject* parent = nullptr);
+    ~ThroughputClient() override;
+
+    bool isRunning() const { return !threads_.empty(); }
+    void start(const QString& host, quint16 port, const ThroughputOptions& opt);
+    void stop();
+
+signals:
+    void message(const QString& text);
+    void intervalReport(const ThroughputInterval& iv);
+    void finished(const ThroughputInterval& total);
+
+private slots:
+    void onTick();
+
+private:
+    void finish();
+
+    ThroughputOptions opt_;
+    std::vector<std::unique_ptr<ThroughputStream>> streams_;
+    std::vector<QThread*> threads_;
+    QTimer tick_;
+    QElapsedTimer clock_;
+    ThroughputInterval last_;
+    double lastCpuSec_ = 0.0;
+    double startCpuSec_ = 0.0;
+    bool reportedConnected_ = false;
+};
+
+// Receiver side: accepts any number of sender connections and discards the
+// data, reporting the aggregate receive rate per interval.
+class ThroughputServer final : public QTcpServer
+{
+    Q_OBJECT
+
+public:
+    explicit ThroughputServer(QObject* parent = nullptr);
+    ~ThroughputServer() override;
+
+    bool start(quint16 port, const ThroughputOptions& opt);
+    void stop();
+
+signals:
+    void message(const QString& text);
+    void intervalReport(const ThroughputInterval& iv);
+    void finished(const ThroughputInterval& total);
+
+protected:
+    void incomingConnection(qintptr socketDescriptor) override;
+
+private slots:
+    void onTick();
+
+private:
+    void reapFinished();
+
+    ThroughputOptions opt_;
+    std::vector<std::unique_ptr<ThroughputStream>> streams_;
+    std::vector<QThread*> threads_;
+    QTimer tick_;
+    QElapsedTimer clock_;
+    ThroughputInterval last_;
+    double lastCpuSec_ = 0.0;
+    double startCpuSec_ = 0.0;
+};
@@ -0,0 +1,94 @@
+#include "TracerouteParser.h"
+#include <QHostAddress>
+#include <QRegularExpression>
+#include <QStringList>
+
+QVector<TraceHop> TracerouteParser::feed(const QString& chunk)
+{
+    QVector<TraceHop> hops;
+    pending_ += chunk;
+
+    const int cut = pending_.lastIndexOf('\n');
+    if (cut < 0) return hops;
+
+    const QString complete = pending_.left(cut);
+    pending_.remove(0, cut + 1);
+
+    for (const auto& line : complete.split('\n'))
+    {
+        TraceHop h;
+        if (parseLine(line, h)) hops << h;
+    }
+    return hops;
+}
+
+QVector<TraceHop> TracerouteParser::finish()
+{
+    QVector<TraceHop> hops;
+    TraceHop h;
+    if (parseLine(pending_, h)) hops << h;
+    pending_.clear();
+    return hops;
+}
+
+bool TracerouteParser::parseLine(const QString& line, TraceHop& hop)
+{
+    // Linux/macOS (traceroute -n):
+    //  1  192.168.1.1  0.512 ms  0.470 ms  0.455 ms
+    //  2  * * *
+    //  3  10.0.0.1  1.234 ms 10.0.0.2  1.456 ms  1.500 ms !H
+    // Windows (tracert -d):
+    //   1    <1 ms    <1 ms    <1 ms  192.168.1.1
+    //   2     *        *        *     Request timed out.
+    static const QRegularExpression ws(R"(\s+)");
+    const QStringList tokens = line.trimmed().split(ws, Qt::SkipEmptyParts);
+    if (tokens.size() < 2) return false;
+
+    bool ok = false;
+    const int n = tokens[0].toInt(&ok);
+    if (!ok || n <= 0) return false;
+
+    TraceHop h;
+    h.hop = n;
+
+    for (int i = 1; i < tokens.size(); ++i)
+    {
+        QString t = tokens[i];
+
+        if (t == "*")
+        {
+            h.rttMs << -1.0;
+            h.rttBelow << false;
+            ++h.timeouts;
+            continue;
+        }
+
+        // "0.512 ms", "12ms", "<1 ms" (tracert's sub-millisecond bound)
+        const bool unitAttached = t.endsWith("ms") && t.size() > 2;
+        if (unitAttached) t.chop(2);
+        const bool below = t.startsWith('<');
+        if (below) t.remove(0, 1);
+        const double v = t.toDouble(&ok);
+        if (ok)
+        {
+            if (unitAttached || (i + 1 < tokens.size() && tokens[i + 1] == "ms"))
+            {
+                h.rttMs << v;
+                h.rttBelow << below;
+            }
+            continue;
+        }
+
+        // Some builds wrap the numeric address: "(10.0.0.1)" or "[2001:db8::1]".
+        QString a = tokens[i];
+        if ((a.startsWith('(') && a.endsWith(')')) || (a.startsWith('[') && a.endsWith(']')))
+            a = a.mid(1, a.size() - 2);
+        if (h.address.isEmpty() && !QHostAddress(a).isNull())
+            h.address = a;
+        // Anything else ("ms", "!H", "Request timed out.") carries no data.
+    }
+
+    if (h.rttMs.isEmpty() && h.address.isEmpty()) return false;
+    hop = h;
+    return true;
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <QString>
+#include <QVector>
+
+struct TraceHop
+{
+    int hop = 0;
+    QString address;        // first responding address; empty if every probe timed out
+    QVector<double> rttMs;  // one per probe, -1 for a timeout ('*')
+    QVector<bool> rttBelow; // per probe: rttMs is an upper bound ("<1 ms"), not a measurement
+    int timeouts = 0;
+    QString hostName;       // filled in later by reverse DNS; empty if none
+    bool resolved = false;  // reverse lookup done (hostName stays empty without a PTR record)
+};
+
+// Incremental parser for numeric (-n / -d) traceroute/tracert output.
+// Feed raw chunks as they arrive; complete hop lines come back as hops.
+class TracerouteParser
+{
+public:
+    QVector<TraceHop> feed(const QString& chunk);
+
+    // Parse whatever is left in the buffer (call when the process ends).
+    QVector<TraceHop> finish();
+
+    // Parse a single line; returns false for non-hop lines (headers etc.).
+    static bool parseLine(const QString& line, TraceHop& hop);
+
+private:
+    QString pending_;
+};
@@ -0,0 +1,181 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
+#include <QTextStream>
+#include <QTimer>
+
+#include "ProbeAgent.h"
+#include "ProbeCollector.h"
+#include "ResultBusPublisher.h"
+
+// Headless PingTool: "agent" probes targets and streams results to a
+// "collector", which merges them per target across agents.
+
+static QTextStream& out()
+{
+    static QTextStream s(stdout);
+    return s;
+}
+
+static void print(const QString& text)
+{
+    out() << text << '\n';
+    out().flush();
+}
+
+static QStringList readTargets(const QString& path, QString* error)
+{
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        *error = f.errorString();
+        return {};
+    }
+
+    QStringList targets;
+    while (!f.atEnd())
+    {
+        const QString line = QString::fromUtf8(f.readLine()).section('#', 0, 0).trimmed();
+        if (!line.isEmpty()) targets << line;
+    }
+    return targets;
+}
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("PingToolNode");
+
+    QCommandLineParser p;
+    p.setApplicationDescription("Distributed PingTool probe agent / result collector.");
+    p.addHelpOption();
+    p.addPositionalArgument("mode", "agent or collector");
+    p.addPositionalArgument("hosts", "agent: targets to probe (in addition to --targets)", "[hosts...]");
+
+    QCommandLineOption listenOpt("listen", "collector: TCP port to listen on", "port", "9300");
+    QCommandLineOption reportOpt("report", "seconds between status reports", "sec", "5");
+    QCommandLineOption topOpt("top", "collector: worst targets shown per report", "n", "20");
+    QCommandLineOption idOpt("id", "agent: unique agent (vantage point) name", "name");
+    QCommandLineOption collectorOpt("collector", "agent: collector address", "host:port", "127.0.0.1:9300");
+    QCommandLineOption targetsOpt("targets", "agent: file with one target per line", "file");
+    QCommandLineOption tcpOpt("tcp", "agent: probe with TCP connects to this port instead of ping", "port");
+    QCommandLineOption intervalOpt("interval", "agent: fast probe interval per target", "sec", "1");
+    QCommandLineOption maxIntervalOpt("max-interval", "agent: backed-off probe interval per target", "sec", "60");
+    QCommandLineOption ppsOpt("pps", "agent: global probe budget (probes per second)", "n", "50");
+    QCommandLineOption shmOpt("shm", QString("agent: also publish results to a shared-memory bus (e.g. %1)")
+        .arg(kResultBusDefaultName), "name");
+    p.addOptions({ listenOpt, reportOpt, topOpt, idOpt, collectorOpt, targetsOpt,
+                   tcpOpt, intervalOpt, maxIntervalOpt, ppsOpt, shmOpt });
+    p.process(app);
+
+    QStringList args = p.positionalArguments();
+    const QString mode = args.isEmpty() ? QString() : args.takeFirst();
+    const int reportMs = qMax(1, p.value(reportOpt).toInt()) * 1000;
+
+    if (mode == "collector")
+    {
+        auto* collector = new ProbeCollector(&app);
+        QObject::connect(collector, &ProbeCollector::message, &app, print);
+
+        const quint16 port = static_cast<quint16>(p.value(listenOpt).toUInt());
+        if (!collector->start(port))
+        {
+            print(QString("Cannot listen on port %1: %2").arg(port).arg(collector->errorString()));
+            return 1;
+        }
+        print(QString("Collector listening on port %1").arg(port));
+
+        const int top = p.value(topOpt).toInt();
+        auto* report = new QTimer(&app);
+        QObject::connect(report, &QTimer::timeout, &app, [collector, top]()
+        {
+            print(collector->summary(top));
+        });
+        report->start(reportMs);
+        return app.exec();
+    }
+
+    if (mode == "agent")
+    {
+        ProbeAgentOptions opt;
+        opt.agentId = p.value(idOpt);
+        if (opt.agentId.isEmpty())
+        {
+            print("agent: --id is required");
+            return 2;
+        }
+        const QString addr = p.value(collectorOpt);
+        const int colon = addr.lastIndexOf(':');
+        opt.collectorHost = colon > 0 ? addr.left(colon) : addr;
+        opt.collectorPort = colon > 0 ? static_cast<quint16>(addr.mid(colon + 1).toUInt()) : 9300;
+
+        QStringList targets = args;
+        if (p.isSet(targetsOpt))
+        {
+            QString error;
+            targets += readTargets(p.value(targetsOpt), &error);
+            if (!error.isEmpty())
+            {
+                print(QString("agent: cannot read %1: %2").arg(p.value(targetsOpt), error));
+                return 2;
+            }
+        }
+        if (targets.isEmpty())
+        {
+            print("agent: no targets");
+            return 2;
+        }
+
+        auto* agent = new ProbeAgent(&app);
+        QObject::connect(agent, &ProbeAgent::message, &app, print);
+
+        AdaptiveRateOptions ro;
+        ro.minIntervalSec = qMax(0.1, p.value(intervalOpt).toDouble());
+        ro.maxIntervalSec = qMax(ro.minIntervalSec, p.value(maxIntervalOpt).toDouble());
+        ro.perTargetMaxPps = 1.0 / ro.minIntervalSec;
+        ro.globalMaxPps = p.value(ppsOpt).toDouble();
+        agent->monitor().setOptions(ro);
+
+        ProbeJob job;
+        if (p.isSet(tcpOpt))
+        {
+            job.kind = ProbeKind::TcpConnect;
+            job.port = static_cast<quint16>(p.value(tcpOpt).toUInt());
+        }
+        else
+        {
+            job.kind = ProbeKind::Ping;
+        }
+        job.ping.count = 1;
+        agent->monitor().setProbeTemplate(job);
+
+        ResultBusPublisher bus;
+        if (p.isSet(shmOpt))
+        {
+            QString error;
+            if (!bus.open(p.value(shmOpt), 65536, &error))
+            {
+                print("agent: " + error);
+                return 2;
+            }
+            agent->monitor().setResultBus(&bus);
+            print(QString("Publishing results to shared memory %1").arg(bus.name()));
+        }
+
+        print(QString("Agent %1: %2 target(s) -> %3:%4")
+            .arg(opt.agentId).arg(targets.size()).arg(opt.collectorHost).arg(opt.collectorPort));
+        agent->start(opt, targets);
+
+        auto* report = new QTimer(&app);
+        QObject::connect(report, &QTimer::timeout, &app, [agent]()
+        {
+            print(QString("Agent: seq %1, acked %2, buffered %3, dropped %4, %5")
+                .arg(agent->lastSeq()).arg(agent->ackedSeq()).arg(agent->buffered())
+                .arg(agent->dropped()).arg(QString(agent->isConnected() ? "connected" : "disconnected")));
+        });
+        report->start(reportMs);
+        return app.exec();
+    }
+
+    p.showHelp(2);
+}
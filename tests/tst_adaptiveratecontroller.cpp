@@ -0,0 +1,176 @@
+#include <QtTest>
+
+#include "AdaptiveRateController.h"
+
+// Scheduling decisions only; time is passed in, so nothing here waits.
+class tst_AdaptiveRateController : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void warmupKeepsFastInterval();
+    void backsOffWhileStable();
+    void snapsBackOnLoss();
+    void snapsBackOnRttJump();
+    void replyWithoutRttIsLoss();
+    void nextDueFollowsInterval();
+    void perTargetCap();
+    void tokenBucketBudget();
+};
+
+static AdaptiveRateOptions options()
+{
+    AdaptiveRateOptions o;
+    o.minIntervalSec = 1.0;
+    o.maxIntervalSec = 8.0;
+    o.backoffFactor = 2.0;
+    o.stableProbesToBackoff = 4;
+    o.perTargetMaxPps = 1.0;
+    o.globalMaxPps = 0.0;  // unlimited unless a test sets it
+    return o;
+}
+
+static ProbeVerdict probe(AdaptiveRateController& c, qint64 nowMs, bool replied, double rttMs)
+{
+    c.markSent(0, nowMs);
+    return c.onResult(0, replied, rttMs);
+}
+
+// Three warm-up replies, then `stable` more at the same RTT.
+static void settle(AdaptiveRateController& c, int stable)
+{
+    for (int i = 0; i < 3 + stable; ++i)
+        probe(c, 0, true, 10.0);
+}
+
+void tst_AdaptiveRateController::warmupKeepsFastInterval()
+{
+    AdaptiveRateController c(options());
+    c.addTarget(0, 0);
+    for (int i = 0; i < 3; ++i)
+    {
+        QCOMPARE(probe(c, 0, true, 10.0), ProbeVerdict::Warmup);
+        QCOMPARE(c.intervalSec(0), 1.0);
+    }
+    QCOMPARE(probe(c, 0, true, 10.0), ProbeVerdict::Stable);
+}
+
+void tst_AdaptiveRateController::backsOffWhileStable()
+{
+    AdaptiveRateController c(options());
+    c.addTarget(0, 0);
+    settle(c, 3);
+    QCOMPARE(c.intervalSec(0), 1.0);
+
+    // Every 4th stable reply doubles the interval, up to the maximum.
+    probe(c, 0, true, 10.0);
+    QCOMPARE(c.intervalSec(0), 2.0);
+    for (int i = 0; i < 4; ++i) probe(c, 0, true, 10.0);
+    QCOMPARE(c.intervalSec(0), 4.0);
+    for (int i = 0; i < 4; ++i) probe(c, 0, true, 10.0);
+    QCOMPARE(c.intervalSec(0), 8.0);
+    for (int i = 0; i < 8; ++i) probe(c, 0, true, 10.0);
+    QCOMPARE(c.intervalSec(0), 8.0);
+}
+
+void tst_AdaptiveRateController::snapsBackOnLoss()
+{
+    AdaptiveRateController c(options());
+    c.addTarget(0, 0);
+    settle(c, 12);
+    QCOMPARE(c.intervalSec(0), 8.0);
+
+    QCOMPARE(probe(c, 0, false, -1.0), ProbeVerdict::Loss);
+    QCOMPARE(c.intervalSec(0), 1.0);
+
+    // The stable streak starts over.
+    for (int i = 0; i < 3; ++i) probe(c, 0, true, 10.0);
+    QCOMPARE(c.intervalSec(0), 1.0);
+    probe(c, 0, true, 10.0);
+    QCOMPARE(c.intervalSec(0), 2.0);
+}
+
+void tst_AdaptiveRateController::snapsBackOnRttJump()
+{
+    AdaptiveRateController c(options());
+    c.addTarget(0, 0);
+    settle(c, 12);
+    QCOMPARE(c.intervalSec(0), 8.0);
+
+    // Small jitter stays inside the band (at least rttChangeFloorMs).
+    QCOMPARE(probe(c, 0, true, 13.0), ProbeVerdict::Stable);
+    QCOMPARE(probe(c, 0, true, 100.0), ProbeVerdict::Changed);
+    QCOMPARE(c.intervalSec(0), 1.0);
+}
+
+void tst_AdaptiveRateController::replyWithoutRttIsLoss()
+{
+    AdaptiveRateController c(options());
+    c.addTarget(0, 0);
+    settle(c, 4);
+    QCOMPARE(c.intervalSec(0), 2.0);
+
+    QCOMPARE(probe(c, 0, true, -1.0), ProbeVerdict::Loss);
+    QCOMPARE(c.intervalSec(0), 1.0);
+}
+
+void tst_AdaptiveRateController::nextDueFollowsInterval()
+{
+    AdaptiveRateController c(options());
+    c.addTarget(0, 0);
+    c.addTarget(1, 500);
+    QCOMPARE(c.dueTargets(0), QVector<int>({ 0 }));
+    QCOMPARE(c.dueTargets(500), QVector<int>({ 0, 1 }));
+
+    // In flight: not due again, and not a reason to wake up.
+    c.markSent(0, 1000);
+    QCOMPARE(c.dueTargets(1000), QVector<int>({ 1 }));
+    QCOMPARE(c.nextWakeMs(), qint64(500));
+
+    c.onResult(0, true, 10.0);
+    QCOMPARE(c.nextDueMs(0), qint64(2000));
+    QVERIFY(c.dueTargets(1999).indexOf(0) < 0);
+    QVERIFY(c.dueTargets(2000).indexOf(0) >= 0);
+}
+
+void tst_AdaptiveRateController::perTargetCap()
+{
+    AdaptiveRateOptions o = options();
+    o.minIntervalSec = 0.1;
+    o.perTargetMaxPps = 0.5;
+    AdaptiveRateController c(o);
+    c.addTarget(0, 0);
+
+    probe(c, 1000, true, 10.0);
+    QCOMPARE(c.intervalSec(0), 2.0);
+    QCOMPARE(c.nextDueMs(0), qint64(3000));
+}
+
+void tst_AdaptiveRateController::tokenBucketBudget()
+{
+    AdaptiveRateOptions o = options();
+    o.globalMaxPps = 10.0;
+    AdaptiveRateController c(o);
+
+    // A full second's worth as a burst, then one token per 100 ms.
+    for (int i = 0; i < 10; ++i)
+        QVERIFY(c.tryAcquire(0));
+    QVERIFY(!c.tryAcquire(0));
+    QCOMPARE(c.msUntilToken(0), qint64(100));
+    QVERIFY(c.tryAcquire(100));
+    QVERIFY(!c.tryAcquire(100));
+
+    // Idle time refills no more than the burst.
+    for (int i = 0; i < 10; ++i)
+        QVERIFY(c.tryAcquire(60000));
+    QVERIFY(!c.tryAcquire(60000));
+
+    // No budget configured: never throttled.
+    AdaptiveRateController unlimited(options());
+    for (int i = 0; i < 1000; ++i)
+        QVERIFY(unlimited.tryAcquire(0));
+    QCOMPARE(unlimited.msUntilToken(0), qint64(0));
+}
+
+QTEST_APPLESS_MAIN(tst_AdaptiveRateController)
+#include "tst_adaptiveratecontroller.moc"
@@ -0,0 +1,78 @@
+#include <QtTest>
+
+#include "ProbeAgent.h"
+#include "ProbeCollector.h"
+
+// Agent and collector talking over loopback; the agent gets no targets, so
+// results are fed in directly with queue() and nothing is probed.
+class tst_ProbeAgent : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void resumesAfterDroppingBufferedResults();
+};
+
+static ResultRecord reply(double rttMs)
+{
+    ResultRecord r;
+    r.targetId = 0;
+    r.timestampMs = QDateTime::currentMSecsSinceEpoch();
+    r.rttUs = quint32(rttMs * 1000.0);
+    r.status = ResultStatus::Reply;
+    return r;
+}
+
+void tst_ProbeAgent::resumesAfterDroppingBufferedResults()
+{
+    ProbeCollector collector;
+    QVERIFY(collector.start(0, QHostAddress::LocalHost));
+    const quint16 port = collector.serverPort();
+
+    ProbeAgentOptions opt;
+    opt.agentId = "a1";
+    opt.collectorHost = "127.0.0.1";
+    opt.collectorPort = port;
+    opt.batchRecords = 4;
+    opt.windowRecords = 16;
+    opt.maxBufferedRecords = 32;
+    opt.flushIntervalMs = 10;
+
+    ProbeAgent agent;
+    agent.start(opt, QStringList());
+    QTRY_VERIFY(agent.isConnected());
+
+    for (int i = 0; i < 10; ++i)
+        agent.queue(reply(1.0));
+    QTRY_COMPARE(agent.ackedSeq(), quint64(10));
+
+    // Outage: more results than the buffer holds, and more dropped ones than
+    // the send window.
+    collector.stop();
+    QTRY_VERIFY(!agent.isConnected());
+    for (int i = 0; i < 100; ++i)
+        agent.queue(reply(2.0));
+    QCOMPARE(agent.buffered(), qint64(32));
+    QCOMPARE(agent.dropped(), qint64(68));
+
+    QVERIFY(collector.start(port, QHostAddress::LocalHost));
+    QTRY_COMPARE_WITH_TIMEOUT(agent.ackedSeq(), quint64(110), 20000);
+    QCOMPARE(agent.buffered(), qint64(0));
+
+    const CollectorAgentState a = collector.agents().value("a1");
+    QCOMPARE(a.connections, 2);
+    QCOMPARE(a.lastSeq, quint64(110));
+    QCOMPARE(a.records, quint64(42));
+    QCOMPARE(a.missing, quint64(68));
+
+    const CollectorTargetStats t = collector.targets().value("#0");
+    QCOMPARE(t.sent, quint64(42));
+    QCOMPARE(t.received, quint64(42));
+
+    // Still streaming after the resume.
+    agent.queue(reply(3.0));
+    QTRY_COMPARE(agent.ackedSeq(), quint64(111));
+}
+
+QTEST_GUILESS_MAIN(tst_ProbeAgent)
+#include "tst_probeagent.moc"
@@ -0,0 +1,108 @@
+#include <QtTest>
+
+#include "TracerouteParser.h"
+
+// Hop lines as printed by traceroute -n (Linux/macOS) and tracert -d (Windows).
+class tst_TracerouteParser : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void unixHop();
+    void unixTimeouts();
+    void unixMultipleAddresses();
+    void unixIpv6PartialTimeout();
+    void windowsBelowOneMs();
+    void windowsTimeouts();
+    void headersAreNotHops();
+    void feedSplitsChunksIntoLines();
+};
+
+void tst_TracerouteParser::unixHop()
+{
+    TraceHop h;
+    QVERIFY(TracerouteParser::parseLine(" 1  192.168.1.1  0.512 ms  0.470 ms  0.455 ms", h));
+    QCOMPARE(h.hop, 1);
+    QCOMPARE(h.address, QString("192.168.1.1"));
+    QCOMPARE(h.rttMs, QVector<double>({ 0.512, 0.470, 0.455 }));
+    QCOMPARE(h.rttBelow, QVector<bool>({ false, false, false }));
+    QCOMPARE(h.timeouts, 0);
+    QVERIFY(!h.resolved);
+}
+
+void tst_TracerouteParser::unixTimeouts()
+{
+    TraceHop h;
+    QVERIFY(TracerouteParser::parseLine(" 2  * * *", h));
+    QCOMPARE(h.hop, 2);
+    QVERIFY(h.address.isEmpty());
+    QCOMPARE(h.rttMs, QVector<double>({ -1.0, -1.0, -1.0 }));
+    QCOMPARE(h.timeouts, 3);
+}
+
+void tst_TracerouteParser::unixMultipleAddresses()
+{
+    // Probes of one hop answered by different routers: the first one is kept.
+    TraceHop h;
+    QVERIFY(TracerouteParser::parseLine(" 3  10.0.0.1  1.234 ms 10.0.0.2  1.456 ms  1.500 ms !H", h));
+    QCOMPARE(h.hop, 3);
+    QCOMPARE(h.address, QString("10.0.0.1"));
+    QCOMPARE(h.rttMs, QVector<double>({ 1.234, 1.456, 1.500 }));
+    QCOMPARE(h.timeouts, 0);
+}
+
+void tst_TracerouteParser::unixIpv6PartialTimeout()
+{
+    TraceHop h;
+    QVERIFY(TracerouteParser::parseLine("12  2001:db8::1  5.100 ms  *  5.300 ms", h));
+    QCOMPARE(h.hop, 12);
+    QCOMPARE(h.address, QString("2001:db8::1"));
+    QCOMPARE(h.rttMs, QVector<double>({ 5.1, -1.0, 5.3 }));
+    QCOMPARE(h.timeouts, 1);
+}
+
+void tst_TracerouteParser::windowsBelowOneMs()
+{
+    TraceHop h;
+    QVERIFY(TracerouteParser::parseLine("  1    <1 ms    <1 ms     2 ms  192.168.1.1", h));
+    QCOMPARE(h.hop, 1);
+    QCOMPARE(h.address, QString("192.168.1.1"));
+    QCOMPARE(h.rttMs, QVector<double>({ 1.0, 1.0, 2.0 }));
+    QCOMPARE(h.rttBelow, QVector<bool>({ true, true, false }));
+}
+
+void tst_TracerouteParser::windowsTimeouts()
+{
+    TraceHop h;
+    QVERIFY(TracerouteParser::parseLine("  2     *        *        *     Request timed out.", h));
+    QCOMPARE(h.hop, 2);
+    QVERIFY(h.address.isEmpty());
+    QCOMPARE(h.timeouts, 3);
+}
+
+void tst_TracerouteParser::headersAreNotHops()
+{
+    TraceHop h;
+    QVERIFY(!TracerouteParser::parseLine("traceroute to 8.8.8.8 (8.8.8.8), 30 hops max, 60 byte packets", h));
+    QVERIFY(!TracerouteParser::parseLine("Tracing route to 8.8.8.8 over a maximum of 30 hops", h));
+    QVERIFY(!TracerouteParser::parseLine("Trace complete.", h));
+    QVERIFY(!TracerouteParser::parseLine("", h));
+}
+
+void tst_TracerouteParser::feedSplitsChunksIntoLines()
+{
+    TracerouteParser p;
+    QVERIFY(p.feed("traceroute to 8.8.8.8 (8.8.8.8), 30 hops max\n 1  192.168.1.1  0.5").isEmpty());
+
+    const QVector<TraceHop> first = p.feed("12 ms  0.470 ms\n 2  * *");
+    QCOMPARE(first.size(), 1);
+    QCOMPARE(first[0].rttMs, QVector<double>({ 0.512, 0.470 }));
+
+    const QVector<TraceHop> rest = p.finish();
+    QCOMPARE(rest.size(), 1);
+    QCOMPARE(rest[0].hop, 2);
+    QCOMPARE(rest[0].timeouts, 2);
+}
+
+QTEST_GUILESS_MAIN(tst_TracerouteParser)
+#include "tst_tracerouteparser.moc"